@@ -0,0 +1,8 @@
+QT += widgets testlib
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+TARGET = qlineeditext_bench
+INCLUDEPATH += ..
+HEADERS += ../qlineeditext.h
+SOURCES += qlineeditext_bench.cpp
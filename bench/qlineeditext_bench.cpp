@@ -0,0 +1,321 @@
+//QLineEditExt benchmarks - QtTest QBENCHMARK functions run under the offscreen platform, with the results optionally converted to JSON:
+//qlineeditext_bench --json results.json [QtTest arguments]
+
+#include <QtTest>
+#include <atomic>
+#include "qlineeditext.h"
+
+#if defined(__GLIBC__)
+//heap allocation counter - malloc/calloc/realloc are interposed and forwarded to glibc, so that the Qt containers allocations are counted too
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *pointer, size_t size);
+static std::atomic<qint64> allocationCount(0);
+extern "C" void *malloc(size_t size) noexcept {allocationCount.fetch_add(1,std::memory_order_relaxed); return __libc_malloc(size);}
+extern "C" void *calloc(size_t count, size_t size) noexcept {allocationCount.fetch_add(1,std::memory_order_relaxed); return __libc_calloc(count,size);}
+extern "C" void *realloc(void *pointer, size_t size) noexcept {allocationCount.fetch_add(1,std::memory_order_relaxed); return __libc_realloc(pointer,size);}
+#define QLINEEDITEXT_BENCH_ALLOCATIONS
+#endif
+
+class QLineEditExtBench : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QList<double> valueList(int count) {QList<double> list; list.reserve(count); for(int i=0; i<count; i++) list.append(double(i)/10.); return list;}
+    static QStringList textList(int count) {QStringList list; list.reserve(count); for(int i=0; i<count; i++) list.append(QString("Entry %1 %2").arg(i).arg(QString::number(i*7919,36))); return list;}
+
+    enum Scale
+    {
+        Step,
+        Count,
+        ValueList,
+        TextList,
+    };
+    static void setScale(QLineEditExt &edit, int scale, int listSize)
+    {
+        if(scale!=TextList)
+            edit.setRange(0.,double(listSize)/10.,1);
+        switch(scale) {
+        case Step: edit.setStep(0.1,1.); edit.setValue(50.); break;
+        case Count: edit.setCount(listSize); edit.setValue(50.); break;
+        case ValueList: edit.setValueList(valueList(listSize)); edit.setValue(50.); break;
+        case TextList: edit.setTextList(textList(listSize)); edit.setText(textList(listSize)[listSize/2]); break;
+        }
+    }
+
+private slots:
+    void paint_data()
+    {
+        QTest::addColumn<bool>("progress");
+        QTest::addColumn<bool>("decorations");
+        QTest::newRow("plain") << false << false;
+        QTest::newRow("progress") << true << false;
+        QTest::newRow("prefix/suffix") << false << true;
+        QTest::newRow("progress, prefix/suffix") << true << true;
+    }
+    void paint()
+    {
+        QFETCH(bool,progress);
+        QFETCH(bool,decorations);
+        QLineEditExt edit;
+        edit.setRange(0.,100.,2);
+        edit.setStep(1.);
+        edit.showProgress(progress);
+        if(decorations) {edit.setPrefix("Gain"); edit.setSuffix("dB");}
+        edit.resize(200,24);
+        edit.setValue(42.);
+        QPixmap pixmap(edit.size());
+        edit.render(&pixmap); //polish
+        QBENCHMARK {
+            edit.render(&pixmap);
+        }
+    }
+
+    void increment_data()
+    {
+        QTest::addColumn<int>("scale");
+        QTest::newRow("step") << int(Step);
+        QTest::newRow("count") << int(Count);
+        QTest::newRow("value list") << int(ValueList);
+        QTest::newRow("text list") << int(TextList);
+    }
+    void increment()
+    {
+        QFETCH(int,scale);
+        QLineEditExt edit;
+        setScale(edit,scale,1000);
+        QBENCHMARK {
+            edit.increment();
+            edit.decrement();
+        }
+    }
+
+    void validate_data()
+    {
+        QTest::addColumn<int>("scale");
+        QTest::addColumn<int>("listSize");
+        QTest::addColumn<QString>("input");
+        QTest::newRow("range") << int(Step) << 1000 << "50.0";
+        QTest::newRow("value list 100k") << int(ValueList) << 100000 << "5000.0";
+        QTest::newRow("text list 100k") << int(TextList) << 100000 << textList(100000)[50000];
+    }
+    void validate()
+    {
+        QFETCH(int,scale);
+        QFETCH(int,listSize);
+        QFETCH(QString,input);
+        QLineEditExt edit;
+        setScale(edit,scale,listSize);
+        const QValidator *validator=edit.QLineEdit::validator();
+        int pos=0;
+        QCOMPARE(validator->validate(input,pos),QValidator::Acceptable);
+        QBENCHMARK {
+            validator->validate(input,pos);
+        }
+    }
+
+    void fixup_data()
+    {
+        QTest::addColumn<int>("scale");
+        QTest::addColumn<int>("listSize");
+        QTest::addColumn<QString>("input");
+        QTest::newRow("range") << int(Step) << 1000 << "150.0";
+        QTest::newRow("value list 100k") << int(ValueList) << 100000 << "5000.04";
+        QTest::newRow("text list 100k") << int(TextList) << 100000 << "entry 5000";
+    }
+    void fixup()
+    {
+        QFETCH(int,scale);
+        QFETCH(int,listSize);
+        QFETCH(QString,input);
+        QLineEditExt edit;
+        setScale(edit,scale,listSize);
+        const QValidator *validator=edit.QLineEdit::validator();
+        QBENCHMARK {
+            QString fixedInput=input;
+            validator->fixup(fixedInput);
+        }
+    }
+
+    //heap allocations of the validation accept path, reported as the events metric
+    void validateAllocations_data() {validate_data();}
+    void validateAllocations()
+    {
+#if defined(QLINEEDITEXT_BENCH_ALLOCATIONS)
+        QFETCH(int,scale);
+        QFETCH(int,listSize);
+        QFETCH(QString,input);
+        QLineEditExt edit;
+        setScale(edit,scale,listSize);
+        const QValidator *validator=edit.QLineEdit::validator();
+        int pos=0;
+        validator->validate(input,pos);
+        qint64 allocations=allocationCount.load();
+        for(int i=0; i<1000; i++)
+            validator->validate(input,pos);
+        allocations=allocationCount.load()-allocations;
+        QTest::setBenchmarkResult(qreal(allocations)/1000.,QTest::Events);
+        QCOMPARE(allocations,qint64(0));
+#else
+        QSKIP("allocations are only counted with glibc");
+#endif
+    }
+
+    //100k entries completion filtering, typed one character at a time
+    void completionFilter_data()
+    {
+        QTest::addColumn<QString>("filter");
+        QTest::newRow("1 character") << "e";
+        QTest::newRow("3 characters") << "y 4";
+        QTest::newRow("6 characters") << "y 4242";
+    }
+    void completionFilter()
+    {
+        QFETCH(QString,filter);
+        QTextListModel model(QSharedPointer<const QTextListIndex>(new QTextListIndex(textList(100000))));
+        QBENCHMARK {
+            for(int i=1; i<=filter.size(); i++)
+                model.setFilter(filter.left(i));
+            model.setFilter(QString());
+        }
+    }
+
+    void dragStream()
+    {
+        QLineEditExt edit;
+        setScale(edit,Step,1000);
+        edit.resize(200,24);
+        QVERIFY(edit.isReadOnly());
+        QBENCHMARK {
+            QMouseEvent press(QEvent::MouseButtonPress,QPointF(10,10),Qt::LeftButton,Qt::LeftButton,Qt::NoModifier);
+            QApplication::sendEvent(&edit,&press);
+            for(int i=1; i<=100; i++)
+            {
+                QMouseEvent move(QEvent::MouseMove,QPointF(10+i*(i%2?4:-4),10),Qt::NoButton,Qt::LeftButton,Qt::NoModifier);
+                QApplication::sendEvent(&edit,&move);
+            }
+            QMouseEvent release(QEvent::MouseButtonRelease,QPointF(10,10),Qt::LeftButton,Qt::NoButton,Qt::NoModifier);
+            QApplication::sendEvent(&edit,&release);
+        }
+    }
+    void wheelStream()
+    {
+        QLineEditExt edit;
+        setScale(edit,Step,1000);
+        edit.resize(200,24);
+        QBENCHMARK {
+            for(int i=0; i<100; i++)
+            {
+                QWheelEvent wheel(QPointF(10,10),QPointF(10,10),QPoint(),QPoint(0,i%2?120:-120),Qt::NoButton,Qt::NoModifier,Qt::NoScrollPhase,false);
+                QApplication::sendEvent(&edit,&wheel);
+            }
+        }
+    }
+
+    //construction and configuration of a panel, and its first frame when shown
+    void panel_data()
+    {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<bool>("show");
+        QTest::newRow("1k widgets") << 1000 << false;
+        QTest::newRow("10k widgets") << 10000 << false;
+        QTest::newRow("5k widgets, first frame") << 5000 << true;
+    }
+    void panel()
+    {
+        QFETCH(int,count);
+        QFETCH(bool,show);
+        QSharedPointer<const QValueDomain> texts=QValueDomain::fromTexts(textList(100));
+        QBENCHMARK {
+            QWidget panel;
+            QGridLayout *layout=new QGridLayout(&panel);
+            for(int i=0; i<count; i++)
+            {
+                QLineEditExt *edit=new QLineEditExt(&panel);
+                QLineEditExt::Batch batch(edit);
+                edit->setRange(0.,100.,1);
+                if(i%4==3) edit->setDomain(texts);
+                else edit->setStep(0.1,1.);
+                edit->setDescription("Gain","dB");
+                layout->addWidget(edit,i/50,i%50);
+            }
+            if(show)
+            {
+                panel.show();
+                panel.grab();
+            }
+        }
+    }
+};
+
+//converts the QtTest XML results into JSON
+static bool writeJson(const QString &xmlFileName, const QString &jsonFileName)
+{
+    QFile xmlFile(xmlFileName);
+    if(!xmlFile.open(QIODevice::ReadOnly))
+        return false;
+    QJsonArray results;
+    QString function;
+    QXmlStreamReader xml(&xmlFile);
+    while(!xml.atEnd())
+    {
+        if(xml.readNext()!=QXmlStreamReader::StartElement)
+            continue;
+        if(xml.name()==QLatin1String("TestFunction"))
+            function=xml.attributes().value("name").toString();
+        if(xml.name()==QLatin1String("BenchmarkResult"))
+        {
+            QJsonObject result;
+            result["function"]=function;
+            result["tag"]=xml.attributes().value("tag").toString();
+            result["metric"]=xml.attributes().value("metric").toString();
+            result["value"]=xml.attributes().value("value").toDouble();
+            result["iterations"]=xml.attributes().value("iterations").toInt();
+            results.append(result);
+        }
+    }
+    QJsonObject root;
+    root["qtVersion"]=QString(qVersion());
+    root["platform"]=QGuiApplication::platformName();
+    root["results"]=results;
+    QFile jsonFile(jsonFileName);
+    if(xml.hasError() || !jsonFile.open(QIODevice::WriteOnly|QIODevice::Truncate))
+        return false;
+    jsonFile.write(QJsonDocument(root).toJson());
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM","offscreen");
+    QApplication app(argc,argv);
+
+    QStringList arguments=app.arguments();
+    QString jsonFileName;
+    int json=arguments.indexOf("--json");
+    if(json>=0 && json+1<arguments.count())
+    {
+        jsonFileName=arguments[json+1];
+        arguments.erase(arguments.begin()+json,arguments.begin()+json+2);
+    }
+    QTemporaryFile xmlFile;
+    if(!jsonFileName.isEmpty())
+    {
+        if(!xmlFile.open())
+            return 1;
+        arguments << "-o" << xmlFile.fileName()+",xml" << "-o" << "-,txt";
+    }
+
+    QLineEditExtBench bench;
+    int result=QTest::qExec(&bench,arguments);
+    if(!jsonFileName.isEmpty() && !writeJson(xmlFile.fileName(),jsonFileName))
+    {
+        qWarning("could not write %s",qPrintable(jsonFileName));
+        return 1;
+    }
+    return result;
+}
+
+#include "qlineeditext_bench.moc"
@@ -3,6 +3,616 @@
 
 #include <QtCore>
 #include <QtWidgets>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+//Indexed text list - the lowercase keys, a text to index hash and a trigram index are built once,
+//so that exact lookups are hash lookups and substring searches only check the entries sharing the rarest trigram of the searched text
+class QTextListIndex
+{
+public:
+    QTextListIndex(const QStringList &list=QStringList()) : texts(list)
+    {
+        keys.reserve(list.count());
+        for(int i=0; i<list.count(); i++)
+        {
+            keys.append(list[i].toLower());
+            if(!indexes.contains(list[i])) indexes.insert(list[i],i);
+            const QString &key=keys.last();
+            for(int j=0; j+2<key.size(); j++)
+            {
+                QVector<int> &postings=trigrams[trigram(key,j)];
+                if(postings.isEmpty() || postings.last()!=i) postings.append(i);
+            }
+        }
+    }
+
+    int count() const {return texts.count();}
+    bool isEmpty() const {return texts.isEmpty();}
+    const QString &text(int i) const {return texts[i];}
+    const QStringList &list() const {return texts;}
+    int indexOf(const QString &text) const {return indexes.value(text,-1);}
+    bool contains(const QString &text) const {return indexes.contains(text);}
+
+    //case insensitive substring search, calls sink(index) for each matching entry in list order until it returns false
+    //candidates (previous matches of a shorter filter) restrict the search when the user extends the filter
+    template<typename Sink> void find(const QString &text, const QVector<int> *candidates, Sink sink) const
+    {
+        QString key=text.toLower();
+        const QVector<int> *postings=candidates;
+        if(key.size()>=3)
+        {
+            for(int j=0; j+2<key.size(); j++)
+            {
+                QHash<quint64,QVector<int> >::const_iterator it=trigrams.constFind(trigram(key,j));
+                if(it==trigrams.constEnd()) return;
+                if(!postings || it->count()<postings->count()) postings=&it.value();
+            }
+        }
+        if(postings)
+        {
+            for(int i : *postings)
+                if(keys[i].contains(key) && !sink(i)) return;
+        } else {
+            for(int i=0; i<keys.count(); i++)
+                if(keys[i].contains(key) && !sink(i)) return;
+        }
+    }
+    QVector<int> find(const QString &text, const QVector<int> *candidates=0) const {QVector<int> matches; find(text,candidates,[&](int i) -> bool {matches.append(i); return true;}); return matches;}
+    int findFirst(const QString &text) const {int first=-1; find(text,0,[&](int i) -> bool {first=i; return false;}); return first;}
+
+private:
+    static quint64 trigram(const QString &key, int i) {return (quint64(key[i].unicode())<<32)|(quint64(key[i+1].unicode())<<16)|quint64(key[i+2].unicode());}
+
+    QStringList texts;
+    QStringList keys;
+    QHash<QString,int> indexes;
+    QHash<quint64,QVector<int> > trigrams;
+};
+
+//Completion model over a QTextListIndex - only the entries matching the current filter are listed
+//when threaded, the search runs in the global thread pool and the matches are streamed into the model by chunks
+class QTextListModel : public QAbstractListModel
+{
+public:
+    QTextListModel(QSharedPointer<const QTextListIndex> textIndex, QObject * parent = 0) : QAbstractListModel(parent), textIndex(textIndex), generation(new QAtomicInt(0))
+    {
+        filtered=searching=threaded=false;
+    }
+    ~QTextListModel() {generation->fetchAndAddOrdered(1);} //cancels the running search
+
+    void setThreaded(bool threaded) {this->threaded=threaded;}
+    void setIndex(QSharedPointer<const QTextListIndex> textIndex)
+    {
+        generation->fetchAndAddOrdered(1);
+        beginResetModel();
+        this->textIndex=textIndex;
+        filter.clear();
+        rows.clear();
+        filtered=searching=false;
+        endResetModel();
+    }
+    void setFilter(const QString &text)
+    {
+        QString key=text.toLower();
+        if(key==filter && (filtered || key.isEmpty())) return;
+        QVector<int> candidates;
+        bool narrowing=filtered && !searching && key.contains(filter);
+        if(narrowing) candidates=rows;
+        filter=key;
+        int current=generation->fetchAndAddOrdered(1)+1;
+
+        beginResetModel();
+        filtered=!key.isEmpty();
+        searching=filtered && threaded;
+        rows.clear();
+        if(filtered && !threaded) rows=textIndex->find(key,narrowing?&candidates:0);
+        endResetModel();
+
+        if(searching)
+            QThreadPool::globalInstance()->start(new Search(textIndex,key,candidates,narrowing,generation,current,this));
+    }
+
+    int rowCount(const QModelIndex &parent=QModelIndex()) const {return parent.isValid()?0:(filtered?rows.count():textIndex->count());}
+    QVariant data(const QModelIndex &modelIndex, int role=Qt::DisplayRole) const
+    {
+        if(!modelIndex.isValid() || (role!=Qt::DisplayRole && role!=Qt::EditRole)) return QVariant();
+        return textIndex->text(filtered?rows[modelIndex.row()]:modelIndex.row());
+    }
+
+private:
+    class Search : public QRunnable
+    {
+    public:
+        Search(QSharedPointer<const QTextListIndex> textIndex, QString key, QVector<int> candidates, bool narrowing, QSharedPointer<QAtomicInt> generation, int current, QTextListModel * model) :
+            textIndex(textIndex), key(key), candidates(candidates), narrowing(narrowing), generation(generation), current(current), model(model) {}
+        void run()
+        {
+            QVector<int> chunk;
+            textIndex->find(key,narrowing?&candidates:0,[&](int i) -> bool {
+                if(generation->loadAcquire()!=current) return false;
+                chunk.append(i);
+                if(chunk.count()==256) {post(chunk,false); chunk.clear();}
+                return true;
+            });
+            post(chunk,true);
+        }
+    private:
+        void post(const QVector<int> &chunk, bool finished)
+        {
+            QPointer<QTextListModel> model=this->model; int current=this->current;
+            QMetaObject::invokeMethod(qApp,[=](){if(model) model->appendRows(current,chunk,finished);},Qt::QueuedConnection);
+        }
+        QSharedPointer<const QTextListIndex> textIndex;
+        QString key;
+        QVector<int> candidates;
+        bool narrowing;
+        QSharedPointer<QAtomicInt> generation;
+        int current;
+        QPointer<QTextListModel> model;
+    };
+
+    void appendRows(int current, const QVector<int> &chunk, bool finished)
+    {
+        if(current!=generation->loadAcquire()) return;
+        if(!chunk.isEmpty())
+        {
+            beginInsertRows(QModelIndex(),rows.count(),rows.count()+chunk.count()-1);
+            rows+=chunk;
+            endInsertRows();
+        }
+        if(finished) searching=false;
+    }
+
+    QSharedPointer<const QTextListIndex> textIndex;
+    QString filter;
+    QVector<int> rows;
+    bool filtered, searching, threaded;
+    QSharedPointer<QAtomicInt> generation;
+};
+
+//Application wide keyboard modifiers tracker - an event filter on the application records the modifiers carried by every input event,
+//so that the CTRL state is known without calling queryKeyboardModifiers (a synchronous round-trip to the display server on X11)
+class QModifierTracker : public QObject
+{
+public:
+    static QModifierTracker * instance()
+    {
+        static QPointer<QModifierTracker> tracker;
+        if(!tracker && qApp)
+        {
+            tracker=new QModifierTracker(qApp);
+            qApp->installEventFilter(tracker);
+        }
+        return tracker;
+    }
+    bool isValid() const {return valid;}
+    Qt::KeyboardModifiers modifiers() const {return m_modifiers;}
+
+protected:
+    bool eventFilter(QObject * object, QEvent * event)
+    {
+        switch(event->type()) {
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease:
+        {
+            //the modifiers of a modifier key event may not include the key itself yet
+            QKeyEvent* keyEvent=(QKeyEvent*)event;
+            m_modifiers=keyEvent->modifiers();
+            Qt::KeyboardModifier modifier=keyModifier(keyEvent->key());
+            if(modifier!=Qt::NoModifier)
+            {
+                if(event->type()==QEvent::KeyPress) m_modifiers|=modifier;
+                else m_modifiers&=~modifier;
+            }
+            valid=true;
+            break;
+        }
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::MouseMove:
+        case QEvent::Wheel:
+        case QEvent::TouchBegin:
+        case QEvent::TouchUpdate:
+        case QEvent::TouchEnd:
+            m_modifiers=((QInputEvent*)event)->modifiers();
+            valid=true;
+            break;
+        case QEvent::ApplicationDeactivate:
+            valid=false; //the modifiers can change while the application doesn't receive the input events
+            break;
+        default:
+            break;
+        }
+        return QObject::eventFilter(object,event);
+    }
+
+private:
+    QModifierTracker(QObject * parent) : QObject(parent) {m_modifiers=Qt::NoModifier; valid=false;}
+    static Qt::KeyboardModifier keyModifier(int key)
+    {
+        switch(key) {
+        case Qt::Key_Control: return Qt::ControlModifier;
+        case Qt::Key_Shift: return Qt::ShiftModifier;
+        case Qt::Key_Alt: return Qt::AltModifier;
+        case Qt::Key_Meta: return Qt::MetaModifier;
+        default: return Qt::NoModifier;
+        }
+    }
+
+    Qt::KeyboardModifiers m_modifiers;
+    bool valid;
+};
+
+//Realtime output - a QLineEditExt publishes its committed (and optionally intermediate) values into a preallocated single producer/single consumer
+//ring buffer and a latest value cell, both lock-free and wait-free, so that a realtime thread can poll them without locking or allocating
+//timestamps are std::chrono::steady_clock nanoseconds
+class QValueOutput
+{
+public:
+    struct Event
+    {
+        double value;
+        qint64 timestamp;
+        bool committed;
+    };
+
+    QValueOutput(int capacity=256)
+    {
+        int size=1;
+        while(size<capacity) size*=2;
+        events.resize(size);
+        buffer=events.data();
+        mask=quint64(size-1);
+        head.store(0); tail.store(0);
+        latest.store(qQNaN());
+    }
+
+    //producer side (GUI thread) - when the consumer doesn't keep up, the newest events are dropped but the latest value is always updated
+    bool publish(double value, qint64 timestamp, bool committed)
+    {
+        latest.store(value,std::memory_order_release);
+        quint64 h=head.load(std::memory_order_relaxed);
+        if(h-tail.load(std::memory_order_acquire)>mask) return false;
+        Event &event=buffer[h&mask];
+        event.value=value; event.timestamp=timestamp; event.committed=committed;
+        head.store(h+1,std::memory_order_release);
+        return true;
+    }
+
+    //consumer side (realtime thread)
+    double latestValue() const {return latest.load(std::memory_order_acquire);}
+    bool poll(Event &event)
+    {
+        quint64 t=tail.load(std::memory_order_relaxed);
+        if(t==head.load(std::memory_order_acquire)) return false;
+        event=buffer[t&mask];
+        tail.store(t+1,std::memory_order_release);
+        return true;
+    }
+
+    static qint64 now() {return qint64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());}
+
+private:
+    Q_DISABLE_COPY(QValueOutput)
+    QVector<Event> events;
+    Event *buffer;
+    quint64 mask;
+    std::atomic<quint64> head, tail;
+    std::atomic<double> latest;
+};
+
+//Per-sample smoothing between the values polled from a QValueOutput, for the realtime consumer - no locking nor allocation
+class QValueSmoother
+{
+public:
+    enum Mode
+    {
+        Linear,
+        Exponential,
+    };
+    QValueSmoother(Mode mode=Linear, int samples=64, double value=0.)
+    {
+        this->mode=mode;
+        this->samples=qMax(samples,1);
+        coefficient=1.-exp(-1./double(this->samples));
+        reset(value);
+    }
+    void reset(double value) {current=target=value; increment=0.; remaining=0;}
+    void setTarget(double target)
+    {
+        this->target=target;
+        remaining=samples;
+        increment=(target-current)/double(samples);
+    }
+    double next()
+    {
+        if(mode==Exponential)
+            current+=(target-current)*coefficient;
+        else if(remaining>0)
+        {
+            current+=increment;
+            if(--remaining==0) current=target;
+        }
+        return current;
+    }
+    double value() const {return current;}
+
+private:
+    Mode mode;
+    int samples, remaining;
+    double coefficient, current, target, increment;
+};
+
+//Value domain - the sorted value lists or the indexed text list of a QLineEditExt
+//it is immutable, so a single domain can be shared by any number of widgets with setDomain instead of each one building its own copy and indexes
+class QValueDomain
+{
+public:
+    static QSharedPointer<const QValueDomain> fromValues(const QList<double> &list, const QList<double> &ctrlList=QList<double>())
+    {
+        QSharedPointer<QValueDomain> domain(new QValueDomain);
+        domain->m_values=sortedValueList(list);
+        domain->m_ctrlValues=ctrlList.isEmpty()?domain->m_values:sortedValueList(ctrlList);
+        return domain;
+    }
+    static QSharedPointer<const QValueDomain> fromTexts(const QStringList &list)
+    {
+        QSharedPointer<QValueDomain> domain(new QValueDomain);
+        domain->m_textIndex=QSharedPointer<const QTextListIndex>(new QTextListIndex(list));
+        return domain;
+    }
+
+    bool isEmpty() const {return m_values.isEmpty() && (!m_textIndex || m_textIndex->isEmpty());}
+    const QVector<double> &values() const {return m_values;}
+    const QVector<double> &ctrlValues() const {return m_ctrlValues;}
+    QSharedPointer<const QTextListIndex> textIndex() const {return m_textIndex;}
+    QStringList texts() const {return m_textIndex?m_textIndex->list():QStringList();}
+
+private:
+    QValueDomain() {}
+    static QVector<double> sortedValueList(const QList<double> &list)
+    {
+        QVector<double> values;
+        values.reserve(list.count());
+        for(double value : list)
+            if(!qIsNaN(value)) values.append(value);
+        std::sort(values.begin(),values.end());
+        values.erase(std::unique(values.begin(),values.end()),values.end());
+        return values;
+    }
+
+    QVector<double> m_values, m_ctrlValues;
+    QSharedPointer<const QTextListIndex> m_textIndex;
+};
+Q_DECLARE_METATYPE(QSharedPointer<const QValueDomain>)
+
+//Instrumentation - only compiled when QLINEEDITEXT_INSTRUMENTATION is defined, otherwise the QLINEEDITEXT_COUNT/QLINEEDITEXT_TIME macros expand to nothing
+//every QLineEditExt counts its paints, validations, fixups, text changes, increments and editingFinished signals, and times its paint and increment paths,
+//both in its own stats() and in QLineEditExtStats::global(), and the timed sections can be written to a Chrome trace file (chrome://tracing or Perfetto)
+#ifdef QLINEEDITEXT_INSTRUMENTATION
+class QLineEditExtStats
+{
+public:
+    enum Counter
+    {
+        Paints,
+        Validates,
+        Fixups,
+        TextChanges,
+        Increments,
+        EditingFinished,
+        CounterCount
+    };
+    enum Timer
+    {
+        PaintTimer,
+        IncrementTimer,
+        TimerCount
+    };
+
+    QLineEditExtStats() {reset();}
+    void reset()
+    {
+        std::fill(counters,counters+CounterCount,0);
+        std::fill(totalTimes,totalTimes+TimerCount,0);
+        std::fill(maxTimes,maxTimes+TimerCount,0);
+    }
+    qint64 count(Counter counter) const {return counters[counter];}
+    //cumulative and max time in nanoseconds
+    qint64 totalTime(Timer timer) const {return totalTimes[timer];}
+    qint64 maxTime(Timer timer) const {return maxTimes[timer];}
+
+    void add(Counter counter) {counters[counter]++;}
+    void addTime(Timer timer, qint64 time) {totalTimes[timer]+=time; maxTimes[timer]=qMax(maxTimes[timer],time);}
+
+    //all the widgets, GUI thread only like the widgets themselves
+    static QLineEditExtStats &global() {static QLineEditExtStats stats; return stats;}
+
+    //Chrome trace output - every timed section is written as a complete event, until stopTrace (or the application exit)
+    //the file is a JSON array left open while tracing, which the trace viewers accept as is, and each event is flushed so that it is complete at any time
+    static bool startTrace(const QString &fileName)
+    {
+        stopTrace();
+        traceFile()=new QFile(fileName);
+        if(traceFile()->open(QIODevice::WriteOnly|QIODevice::Truncate|QIODevice::Text))
+        {
+            static bool closedOnExit=false;
+            if(!closedOnExit) {qAddPostRoutine(stopTrace); closedOnExit=true;}
+            traceFile()->write("[\n");
+            traceFile()->flush();
+            return true;
+        }
+        stopTrace();
+        return false;
+    }
+    static void stopTrace()
+    {
+        if(!traceFile()) return;
+        if(traceFile()->isOpen()) traceFile()->write("{}]\n");
+        delete traceFile();
+        traceFile()=0;
+    }
+    static void traceEvent(const char *name, const QObject *widget, qint64 start, qint64 duration)
+    {
+        if(!traceFile()) return;
+        QString objectName=widget->objectName();
+        objectName.replace("\\","\\\\").replace("\"","\\\"");
+        traceFile()->write(QString("{\"name\":\"%1\",\"ph\":\"X\",\"ts\":%2,\"dur\":%3,\"pid\":%4,\"tid\":0,\"args\":{\"widget\":\"0x%5\",\"objectName\":\"%6\"}},\n")
+                           .arg(QLatin1String(name)).arg(double(start)/1000.,0,'f',3).arg(double(duration)/1000.,0,'f',3).arg(QCoreApplication::applicationPid())
+                           .arg(quintptr(widget),0,16).arg(objectName).toUtf8());
+        traceFile()->flush();
+    }
+
+    static qint64 now() {return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();}
+
+private:
+    static QFile *&traceFile() {static QFile *file=0; return file;}
+
+    qint64 counters[CounterCount];
+    qint64 totalTimes[TimerCount];
+    qint64 maxTimes[TimerCount];
+};
+
+//times the enclosing scope into the widget and global stats, and the trace
+class QLineEditExtTimer
+{
+public:
+    QLineEditExtTimer(QLineEditExtStats &stats, QLineEditExtStats::Timer timer, const char *name, const QObject *widget) : stats(stats), timer(timer), name(name), widget(widget) {start=QLineEditExtStats::now();}
+    ~QLineEditExtTimer()
+    {
+        qint64 duration=QLineEditExtStats::now()-start;
+        stats.addTime(timer,duration);
+        QLineEditExtStats::global().addTime(timer,duration);
+        QLineEditExtStats::traceEvent(name,widget,start,duration);
+    }
+private:
+    Q_DISABLE_COPY(QLineEditExtTimer)
+    QLineEditExtStats &stats;
+    QLineEditExtStats::Timer timer;
+    const char *name;
+    const QObject *widget;
+    qint64 start;
+};
+
+#define QLINEEDITEXT_COUNT(stats, counter) do {(stats).add(QLineEditExtStats::counter); QLineEditExtStats::global().add(QLineEditExtStats::counter);} while(0)
+#define QLINEEDITEXT_TIME(stats, timer, name) QLineEditExtTimer qlineeditextTimer(stats,QLineEditExtStats::timer,name,this)
+#else
+#define QLINEEDITEXT_COUNT(stats, counter) do {} while(0)
+#define QLINEEDITEXT_TIME(stats, timer, name) do {} while(0)
+#endif
+
+//Fixed-point value with N decimals, stored as an integer number of 10^-N units
+template<int N> struct QDecimal
+{
+    static constexpr qint64 scale(int decimals=N) {return decimals<=0?1:10*scale(decimals-1);}
+    static QDecimal fromUnits(qint64 units) {QDecimal decimal; decimal.units=units; return decimal;}
+
+    QDecimal() : units(0) {}
+    QDecimal(double value) : units(roundedUnits(value*double(scale()))) {}
+    double toDouble() const {return double(units)/double(scale());}
+    //nearest number of units, NaN as 0 and saturated to the qint64 limits like the integer values
+    static qint64 roundedUnits(double units)
+    {
+        if(qIsNaN(units)) return 0;
+        if(units>=double(std::numeric_limits<qint64>::max())) return std::numeric_limits<qint64>::max();
+        if(units<=double(std::numeric_limits<qint64>::min())) return std::numeric_limits<qint64>::min();
+        return qint64(std::llround(units));
+    }
+
+    bool operator==(const QDecimal &other) const {return units==other.units;}
+    bool operator!=(const QDecimal &other) const {return units!=other.units;}
+    bool operator<(const QDecimal &other) const {return units<other.units;}
+
+    qint64 units;
+};
+
+//Value types of QLineEditExtT - conversion from/to the double of the widget, exact stepping, formatting and parsing
+//integers and QDecimal are stepped and formatted as integers, so they don't drift nor go through the floating-point formatting
+template<typename T> struct QIntegerValueTraits
+{
+    static const int decimals=0;
+    static T fromDouble(double value)
+    {
+        if(qIsNaN(value)) return T(0);
+        if(value>=double(std::numeric_limits<T>::max())) return std::numeric_limits<T>::max();
+        if(value<=double(std::numeric_limits<T>::min())) return std::numeric_limits<T>::min();
+        return T(std::llround(value));
+    }
+    static double toDouble(T value) {return double(value);}
+    //saturating value+step*steps
+    static T add(T value, T step, int steps)
+    {
+        const T lowest=std::numeric_limits<T>::min(), highest=std::numeric_limits<T>::max();
+        if(step==0 || steps==0) return value;
+        //lowest/-1 overflows, and step*steps can't overflow for a step of -1 anyway
+        if(step>0 ? T(qAbs(steps))>highest/step : step!=T(-1) && T(qAbs(steps))>lowest/step) return (steps>0)==(step>0)?highest:lowest;
+        T delta=step*T(steps);
+        if(delta>0 && value>highest-delta) return highest;
+        if(delta<0 && value<lowest-delta) return lowest;
+        return value+delta;
+    }
+    static QString toString(T value, int) {return QString::number(value);}
+    static T parse(const QString &text, bool *ok)
+    {
+        qlonglong value=text.toLongLong(ok);
+        if(!*ok) return fromDouble(text.toDouble(ok)); //decimals or exponent
+        return value>qlonglong(std::numeric_limits<T>::max())?std::numeric_limits<T>::max():value<qlonglong(std::numeric_limits<T>::min())?std::numeric_limits<T>::min():T(value);
+    }
+};
+template<typename T> struct QValueTraits;
+template<> struct QValueTraits<int> : QIntegerValueTraits<int> {};
+template<> struct QValueTraits<qint64> : QIntegerValueTraits<qint64> {};
+template<int N> struct QValueTraits<QDecimal<N> >
+{
+    static const int decimals=N;
+    static QDecimal<N> fromDouble(double value) {return qIsNaN(value)?QDecimal<N>():QDecimal<N>(value);}
+    static double toDouble(QDecimal<N> value) {return value.toDouble();}
+    static QDecimal<N> add(QDecimal<N> value, QDecimal<N> step, int steps) {return QDecimal<N>::fromUnits(QIntegerValueTraits<qint64>::add(value.units,step.units,steps));}
+    static QString toString(QDecimal<N> value, int)
+    {
+        QString digits=QString::number(qAbs(value.units)).rightJustified(N+1,'0');
+        QString text=value.units<0?"-":"";
+        text+=digits.left(digits.size()-N);
+        if(N>0) text+="."+digits.right(N);
+        return text;
+    }
+    static QDecimal<N> parse(const QString &text, bool *ok)
+    {
+        QString trimmed=text.trimmed();
+        int i=0, fraction=-1;
+        bool negative=false, digits=false, roundUp=false;
+        qint64 units=0;
+        if(i<trimmed.size() && (trimmed[i]=='-' || trimmed[i]=='+')) negative=trimmed[i++]=='-';
+        for(; i<trimmed.size(); i++)
+        {
+            QChar c=trimmed[i];
+            if(c=='.' && fraction<0) {fraction=0; continue;}
+            if(!c.isDigit() || (fraction<N && units>std::numeric_limits<qint64>::max()/10/QDecimal<N>::scale()))
+                return fromDouble(trimmed.toDouble(ok)); //exponent or out of the exact range
+            if(fraction<N) units=units*10+c.digitValue();
+            else roundUp=roundUp || (fraction==N && c.digitValue()>=5); //decimals beyond N round half away from zero, from the text itself
+            digits=true;
+            if(fraction>=0) fraction++;
+        }
+        *ok=digits;
+        units=units*QDecimal<N>::scale(N-qMax(fraction,0))+(roundUp?1:0);
+        return QDecimal<N>::fromUnits(negative?-units:units);
+    }
+};
+template<> struct QValueTraits<double>
+{
+    static const int decimals=-1; //defined at runtime by setRange
+    static double fromDouble(double value) {return value;}
+    static double toDouble(double value) {return value;}
+    static double add(double value, double step, int steps) {return value+double(steps)*step;}
+    static QString toString(double value, int decimals) {return QString::number(value,'f',decimals);}
+    static double parse(const QString &text, bool *ok) {return text.toDouble(ok);}
+};
 
 class QLineEditExt : public QLineEdit
 {
@@ -28,11 +638,32 @@ public:
         prefixMargin=suffixMargin=0;
         m_incrementDiff=None;
         incrementable=false;
+        decimalScale=1.;
+        textAcceptable=settingText=false;
+        output=0;
+        publishIntermediate=false;
+        parseText(text());
+        prefixWidth=suffixWidth=0;
+        textWidth=-1;
+        updatingStyle=false;
+        paintedProgressWidth=-1;
+        valueIndex=-1;
+        textCompleter=0;
+        textModel=0;
+        threadedCompletion=false;
+        batchDepth=0;
+        pendingValidate=pendingLayout=pendingUpdate=false;
+        coalesceIncrements=incrementScheduled=false;
+        pendingSteps=0;
+        hasEventModifiers=false;
+        QModifierTracker::instance();
+        m_feed=QSharedPointer<Feed>(new Feed(this));
 
         setAttribute(Qt::WA_AcceptTouchEvents,true);
-        setMouseTracking(true);
         setValidator(&validator);
-        connect(this,&QLineEdit::editingFinished,[=](){finishEditing();});
+        connect(this,&QLineEdit::editingFinished,[=](){QLINEEDITEXT_COUNT(m_stats,EditingFinished); finishEditing(); publishValue(true);});
+        connect(this,&QLineEdit::textChanged,[=](const QString &text){onTextChanged(text);});
+        connect(this,&QLineEdit::textEdited,[=](const QString &text){if(ensureTextCompleter()) {textModel->setFilter(text); textCompleter->complete();}});
     }
     QLineEditExt(const QString & contents, QWidget * parent = 0) : QLineEdit(contents, parent), validator(this) {
         min=max=m_step=ctrlStep=0.;
@@ -48,15 +679,36 @@ public:
         prefixMargin=suffixMargin=0;
         m_incrementDiff=None;
         incrementable=false;
+        decimalScale=1.;
+        textAcceptable=settingText=false;
+        output=0;
+        publishIntermediate=false;
+        parseText(text());
+        prefixWidth=suffixWidth=0;
+        textWidth=-1;
+        updatingStyle=false;
+        paintedProgressWidth=-1;
+        valueIndex=-1;
+        textCompleter=0;
+        textModel=0;
+        threadedCompletion=false;
+        batchDepth=0;
+        pendingValidate=pendingLayout=pendingUpdate=false;
+        coalesceIncrements=incrementScheduled=false;
+        pendingSteps=0;
+        hasEventModifiers=false;
+        QModifierTracker::instance();
+        m_feed=QSharedPointer<Feed>(new Feed(this));
 
         setAttribute(Qt::WA_AcceptTouchEvents,true);
-        setMouseTracking(true);
         setValidator(&validator);
-        connect(this,&QLineEdit::editingFinished,[=](){finishEditing();});
+        connect(this,&QLineEdit::editingFinished,[=](){QLINEEDITEXT_COUNT(m_stats,EditingFinished); finishEditing(); publishValue(true);});
+        connect(this,&QLineEdit::textChanged,[=](const QString &text){onTextChanged(text);});
+        connect(this,&QLineEdit::textEdited,[=](const QString &text){if(ensureTextCompleter()) {textModel->setFilter(text); textCompleter->complete();}});
     }
 
     //Min/Max Range - also defines the number of decimals, and if set to strict, won't allow the user to go below or above the defined range
-    void setRange(double min, double max, int decimals=0, bool minStrict=true, bool maxStrict=true) {this->min=min; this->max=max; this->decimals=decimals; this->minStrict=minStrict; this->maxStrict=maxStrict; validator.setRange(min,max,decimals,minStrict,maxStrict); finishEditing();}
+    void setRange(double min, double max, int decimals=0, bool minStrict=true, bool maxStrict=true) {this->min=min; this->max=max; this->decimals=decimals; this->minStrict=minStrict; this->maxStrict=maxStrict; decimalScale=pow(10.,decimals); validator.setRange(min,max,decimals,minStrict,maxStrict); refreshPowerTables(); revalidate();}
 
     //Increment (either by mouse/finger drag, mouse wheel, or arrows up/down)
     //4 methods (with optionnal micro-increment when holding the CTRL key):
@@ -65,106 +717,166 @@ public:
     //-setCount (set a number of total step, and define a gamma so that increment react accordingly to micro and large scales - requires a range)
     //-setValueList (set specific values - if set to strict, will only accept the values from the list)
     //-setTextList (set specific texts - activate a pop-up completer and if set to strict, will only accept the strings from the list)
+    //  the list is indexed once, the completer lists the entries containing the typed text and can search in a worker thread with setTextCompletionThreaded
+    //-setDomain (set a value or text list from a QValueDomain, which can be shared between many widgets)
     //the setIncrementDragDistance define the distance treshold at which an increment is considered
-    void setIncrementable(bool incrementable=true){this->incrementable=incrementable; m_step=ctrlStep=0.; m_count=ctrlCount=0; m_valueList.clear(); m_valueCtrlList.clear(); m_textList.clear(); validator.setValueList(); if(completer()) delete completer(); setCompleter(0); finishEditing();}
-    void setStep(double step, double ctrlStep=0.) {setIncrementable(step>0); this->m_step=step; this->ctrlStep=ctrlStep==0.?step:ctrlStep; finishEditing();}
-    void setCount(int count, int ctrlCount=0, double power=2.) {setIncrementable(count>0); this->m_count=count; this->ctrlCount=ctrlCount==0?count:ctrlCount; this->m_power=power; finishEditing();}
-    void setValueList(QList<double> list, QList<double> ctrlList=QList<double>(), bool strict=true) {setIncrementable(!list.isEmpty()); this->m_valueList=list; this->m_valueCtrlList=ctrlList.isEmpty()?list:ctrlList; this->listStrict=strict; validator.setValueList(m_valueCtrlList,strict); finishEditing();}
-    void setTextList(QStringList list, bool strict=true) {setIncrementable(!list.isEmpty()); this->m_textList=list; this->listStrict=strict; validator.setTextList(list,strict); if(!list.isEmpty()){setCompleter(new QCompleter(list,this)); completer()->setCaseSensitivity(Qt::CaseInsensitive); completer()->setCompletionMode(QCompleter::UnfilteredPopupCompletion); completer()->setFilterMode(Qt::MatchContains); completer()->setMaxVisibleItems(10); completer()->setWrapAround(false); connect(completer(), static_cast<void(QCompleter::*)(const QString &)>(&QCompleter::activated),[&](const QString &text){finishEditing(); emit editingFinished();});} refreshLayout(); finishEditing();}
+    void setIncrementable(bool incrementable=true){resetIncrement(incrementable); revalidate();}
+    void setStep(double step, double ctrlStep=0.) {resetIncrement(step>0); this->m_step=step; this->ctrlStep=ctrlStep==0.?step:ctrlStep; revalidate();}
+    void setCount(int count, int ctrlCount=0, double power=2.) {resetIncrement(count>0); this->m_count=count; this->ctrlCount=ctrlCount==0?count:ctrlCount; this->m_power=power; refreshPowerTables(); revalidate();}
+    void setValueList(QList<double> list, QList<double> ctrlList=QList<double>(), bool strict=true) {setDomain(QValueDomain::fromValues(list,ctrlList),strict);}
+    void setTextList(QStringList list, bool strict=true) {setDomain(QValueDomain::fromTexts(list),strict);}
+    void setDomain(QSharedPointer<const QValueDomain> domain, bool strict=true)
+    {
+        bool hasTexts=domain && domain->textIndex() && !domain->textIndex()->isEmpty();
+        resetIncrement(domain && !domain->isEmpty(),hasTexts);
+        if(!domain) {revalidate(); return;}
+        m_domain=domain;
+        listStrict=strict;
+        if(domain->textIndex())
+        {
+            m_textList=domain->texts();
+            textIndex=domain->textIndex();
+            validator.setTextList(textIndex,strict);
+            if(textCompleter) textModel->setIndex(textIndex); //otherwise created on first focus or edit
+            refreshLayout();
+        } else {
+            m_valueList=domain->values();
+            m_valueCtrlList=domain->ctrlValues();
+            valueIndex=-1;
+            validator.setValueList(m_valueCtrlList,strict);
+        }
+        revalidate();
+    }
+    QSharedPointer<const QValueDomain> domain() {return m_domain;}
+    void setTextCompletionThreaded(bool threaded=true) {threadedCompletion=threaded; if(textModel) textModel->setThreaded(threaded);}
     void setIncrementDragDistance(int mouse=8, int touch=12) {dragStep=mouseDragStep=mouse; touchDragStep=touch;}
-    bool ctrlPressed(){return qApp->queryKeyboardModifiers()&Qt::ControlModifier;}
+    bool ctrlPressed()
+    {
+        //modifiers of the input event being handled, otherwise the application wide tracked ones, and only when nothing was tracked yet the queried ones
+        if(hasEventModifiers) return eventModifiers&Qt::ControlModifier;
+        QModifierTracker *tracker=QModifierTracker::instance();
+        if(tracker && tracker->isValid()) return tracker->modifiers()&Qt::ControlModifier;
+        return qApp->queryKeyboardModifiers()&Qt::ControlModifier;
+    }
     IncrementDiff incrementDiff(){return m_incrementDiff;}
 
     //Current Value - when defining a default value/text, user can reset to it by double-clicking the widget
+    //the value is cached and only parsed/formatted once per change, valueIsValid tells if the current text is a number
     void setDefaultValue(double value=qQNaN()) {defaultValue=value; defaultText.clear(); setValue(value);}
     void setDefaultText(QString text=QString()) {defaultText=text; defaultValue=qQNaN(); setText(text);}
-    void setValue(double value) {setText(QString::number(value,'f',decimals)); finishEditing();}
-    double value() { return text().toDouble();}
+    void setValue(double value)
+    {
+        if(m_textList.isEmpty()) value=validator.fixupValue(value);
+        value=roundedValue(value);
+        QString newText=formatValue(value);
+        if(newText!=text()) {settingText=true; setText(newText); settingText=false;}
+        m_value=value;
+        m_valueValid=!qIsNaN(value);
+        publishValue(false);
+        textAcceptable=m_textList.isEmpty(); //already fixed up numerically, text lists still need the text validation
+        finishEditing();
+    }
+    double value() { return m_value;}
     int intValue() { return qRound(value());}
+    bool valueIsValid() { return m_valueValid;}
 
     //Decoration - show a progress bar (default: auto value, otherwise you can forceProgress value from 0 to 1), define optional prefix and suffix or all at once and more with the setDescription method
     //the progress bar color can be styled with the alternate-background-color stylesheet property
-    void showProgress(bool show) { progress=show; update(); }
-    void forceProgress(double progress=-1.) { forcedProgress=progress; update(); }
-    void setPrefix(QString prefix){this->prefix=prefix+(prefix.isEmpty()?"":" "); refreshLayout(); update();}
-    void setSuffix(QString suffix){this->suffix=(suffix.isEmpty()?"":" ")+suffix; refreshLayout(); update();}
-    void setDescription(QString prefix, QString suffix, bool progress=true, int rightMargin=0, Qt::Alignment alignment=Qt::AlignCenter){setContentsMargins(0,0,rightMargin,0); setAlignment(alignment); this->progress=progress; setPrefix(prefix); setSuffix(suffix);}
+    void showProgress(bool show) { progress=show; refreshBackground(); requestUpdate(); }
+    void forceProgress(double progress=-1.) { forcedProgress=progress; updateProgress(); }
+    void setPrefix(QString prefix){this->prefix=prefix+(prefix.isEmpty()?"":" "); refreshLayout(); requestUpdate();}
+    void setSuffix(QString suffix){this->suffix=(suffix.isEmpty()?"":" ")+suffix; refreshLayout(); requestUpdate();}
+    void setDescription(QString prefix, QString suffix, bool progress=true, int rightMargin=0, Qt::Alignment alignment=Qt::AlignCenter){beginUpdate(); setContentsMargins(0,0,rightMargin,0); setAlignment(alignment); this->progress=progress; refreshBackground(); setPrefix(prefix); setSuffix(suffix); endUpdate();}
 
-    //Manual increment/decrement
-    void increment()
+    //Batch configuration - between beginUpdate and endUpdate (or during the lifetime of a Batch object), the setters only record their changes
+    //and the validation, layout and repaint happen once at the end
+    void beginUpdate() {batchDepth++;}
+    void endUpdate()
     {
-        if(m_step!=0.)
-            setValue(value()+currentStep());
-        if(m_count!=0 && min<max)
-        {
-            double normalizedValue=pow((value()-min)/(max-min),1./m_power);
-            normalizedValue=qMax(normalizedValue+1./double(currentCount()),0.);
-            double newValue=pow(normalizedValue,m_power)*(max-min)+min;
-            if(newValue-value()<pow(10.,double(-decimals))) newValue=value()+pow(10.,double(-decimals));
-            setValue(newValue);
-        }
-        if(!m_valueList.isEmpty())
+        if(batchDepth==0 || --batchDepth>0) return;
+        if(pendingLayout) {pendingLayout=false; refreshLayout();}
+        if(pendingValidate) finishEditing();
+        if(pendingUpdate) update();
+        pendingValidate=pendingUpdate=false;
+    }
+    class Batch
+    {
+    public:
+        Batch(QLineEditExt * edit) : edit(edit) {edit->beginUpdate();}
+        ~Batch() {edit->endUpdate();}
+    private:
+        QLineEditExt * edit;
+    };
+
+    //Thread-safe feed - postValue and postProgress can be called from any thread at any rate without blocking, only the latest value is kept
+    //and the GUI thread applies it at most once per frame, skipping the update when it wouldn't be visible (same displayed value or progress width)
+    //producers that may outlive the widget keep the feed() and post to it instead, their posts are dropped once the widget is destroyed
+    class Feed
+    {
+    public:
+        void postValue(double value) {this->value.store(value); post(PostedValue);}
+        void postProgress(double progress) {this->progress.store(progress); post(PostedProgress);}
+    private:
+        friend class QLineEditExt;
+        Feed(QLineEditExt *edit) : edit(edit) {value=progress=0.; flags=0; scheduled=false;}
+        Q_DISABLE_COPY(Feed)
+        //the widget is only dereferenced in the GUI thread, through the QPointer
+        void post(int flag)
         {
-            if(ctrlPressed()) {
-                int i;
-                for(i=0; i<m_valueCtrlList.count(); i++)
-                    if(m_valueCtrlList[i]>value()) {setValue(m_valueCtrlList[qBound(0,i,m_valueCtrlList.count()-1)]); break;}
-                if(i==m_valueCtrlList.count())
-                    setValue(m_valueCtrlList.last());
-            } else {
-                int i;
-                for(i=0; i<m_valueList.count(); i++)
-                    if(m_valueList[i]>value()) {setValue(m_valueList[qBound(0,i,m_valueList.count()-1)]); break;}
-                if(i==m_valueList.count())
-                    setValue(m_valueList.last());
-            }
+            flags.fetch_or(flag);
+            if(scheduled.exchange(true))
+                return;
+            QPointer<QLineEditExt> edit=this->edit;
+            QMetaObject::invokeMethod(qApp,[edit](){if(edit) edit->applyFeed();},Qt::QueuedConnection);
         }
-        if(!m_textList.isEmpty())
-            setText(m_textList[qBound(0,m_textList.indexOf(text())+1,m_textList.count()-1)]);
-        if(!isReadOnly())
-            selectAll();
-        finishEditing();
-        m_incrementDiff=Increment;
-        emit editingFinished();
-        m_incrementDiff=None;
-    }
-    void decrement()
+
+        QPointer<QLineEditExt> edit;
+        std::atomic<double> value, progress;
+        std::atomic<int> flags;
+        std::atomic<bool> scheduled;
+    };
+    QSharedPointer<Feed> feed() const {return m_feed;}
+    void postValue(double value) {m_feed->postValue(value);}
+    void postProgress(double progress) {m_feed->postProgress(progress);}
+
+    //Realtime output - every committed value (editingFinished) is published to the output, and when publishIntermediate is set every value set
+    //by setValue or an increment too, once fixed up - the text being typed is only published when committed
+    //the output isn't owned by the widget
+    void setOutput(QValueOutput *output, bool publishIntermediate=false) {this->output=output; this->publishIntermediate=publishIntermediate; publishValue(true);}
+
+    //Manual increment/decrement - several steps are computed at once and applied with a single editingFinished signal
+    void increment(int steps=1)
     {
+        if(steps==0)
+            return;
+        QLINEEDITEXT_COUNT(m_stats,Increments);
+        QLINEEDITEXT_TIME(m_stats,IncrementTimer,"increment");
+        bool ctrl=ctrlPressed();
         if(m_step!=0.)
-            setValue(value()-currentStep());
+            setValue(linearSteppedValue(value(),steps,ctrl?ctrlStep:m_step));
         if(m_count!=0 && min<max)
-        {
-            double normalizedValue=pow((value()-min)/(max-min),1./m_power);
-            normalizedValue=qMax(normalizedValue-1./double(currentCount()),0.);
-            double newValue=pow(normalizedValue,m_power)*(max-min)+min;
-            if(value()-newValue<pow(10.,double(-decimals))) newValue=value()-pow(10.,double(-decimals));
-            setValue(newValue);
-        }
+            setValue(powerSteppedValue(ctrl?ctrlCountTable:countTable,ctrl?ctrlCount:m_count,min,max,m_power,!minStrict,!maxStrict,value(),steps,decimalScale,valueIndex));
         if(!m_valueList.isEmpty())
-        {
-            if(ctrlPressed()) {
-                int i;
-                for(i=0; i<m_valueCtrlList.count(); i++)
-                    if(m_valueCtrlList[i]>=value()) {setValue(m_valueCtrlList[qBound(0,i-1,m_valueCtrlList.count()-1)]); break;}
-                if(i==m_valueCtrlList.count())
-                    setValue(m_valueCtrlList.last());
-            } else {
-                int i;
-                for(i=0; i<m_valueList.count(); i++)
-                    if(m_valueList[i]>=value()) {setValue(m_valueList[qBound(0,i-1,m_valueList.count()-1)]); break;}
-                if(i==m_valueList.count())
-                    setValue(m_valueList.last());
-            }
-        }
+            setValue(steppedListValue(ctrl?m_valueCtrlList:m_valueList,steps));
         if(!m_textList.isEmpty())
-            setText(m_textList[qBound(0,m_textList.indexOf(text())-1,m_textList.count()-1)]);
+            setText(m_textList[qBound(0,textIndex->indexOf(text())+steps,m_textList.count()-1)]);
         if(!isReadOnly())
             selectAll();
         finishEditing();
-        m_incrementDiff=Decrement;
+        m_incrementDiff=steps>0?Increment:Decrement;
         emit editingFinished();
         m_incrementDiff=None;
     }
+    void decrement(int steps=1) {increment(-steps);}
+
+    //when coalescing, the increments from drag, wheel and key repeat are accumulated and applied at most once per frame
+    void setIncrementCoalescing(bool coalesce=true) {coalesceIncrements=coalesce;}
+
+#ifdef QLINEEDITEXT_INSTRUMENTATION
+    //Instrumentation - counters and timers of this widget, see QLineEditExtStats
+    const QLineEditExtStats &stats() const {return m_stats;}
+    void resetStats() {m_stats.reset();}
+#endif
 
 protected:
     double currentStep() {return ctrlPressed()?ctrlStep:m_step;}
@@ -181,11 +893,15 @@ protected:
             usingTouchKeyboard=false;
         }
 #endif
-        QString input=text(); int pos=0;
-        if(validator.validate(input,pos)!=QValidator::Acceptable)
+        if(!textAcceptable)
         {
-            validator.fixup(input);
-            setText(input);
+            QString input=text(); int pos=0;
+            if(validator.validate(input,pos)!=QValidator::Acceptable)
+            {
+                validator.fixup(input);
+                setText(input);
+            }
+            textAcceptable=true;
         }
         if(incrementable) {
             setReadOnly(true);
@@ -193,8 +909,156 @@ protected:
         }
     }
 
+    enum PostedFlag
+    {
+        PostedValue=1,
+        PostedProgress=2,
+    };
+    void applyFeed()
+    {
+        if(feedTimer.isValid() && feedTimer.elapsed()<16)
+        {
+            QTimer::singleShot(int(16-feedTimer.elapsed()),this,[=](){applyFeed();});
+            return;
+        }
+        feedTimer.start();
+        m_feed->scheduled.store(false);
+        int flags=m_feed->flags.exchange(0);
+        if(flags&PostedValue)
+        {
+            double value=m_feed->value.load();
+            if(!m_valueValid || roundedValue(m_textList.isEmpty()?validator.fixupValue(value):value)!=m_value)
+                setValue(value);
+        }
+        if(flags&PostedProgress)
+        {
+            double progress=m_feed->progress.load();
+            int contentsWidth=width()-contentsMargins().left()-contentsMargins().right();
+            bool visible=qRound(double(contentsWidth)*qMin(progress,1.))!=qRound(double(contentsWidth)*qMin(forcedProgress,1.)) || (progress<0.)!=(forcedProgress<0.);
+            forcedProgress=progress;
+            if(visible) updateProgress();
+        }
+    }
+
+    void inputIncrement(int steps, Qt::KeyboardModifiers modifiers)
+    {
+        if(steps==0)
+            return;
+        if(!coalesceIncrements)
+        {
+            eventIncrement(steps,modifiers);
+            return;
+        }
+        pendingSteps+=steps;
+        pendingModifiers=modifiers;
+        if(!incrementScheduled)
+        {
+            incrementScheduled=true;
+            QTimer::singleShot(16,this,[=](){incrementScheduled=false; int steps=pendingSteps; pendingSteps=0; eventIncrement(steps,pendingModifiers);});
+        }
+    }
+    void eventIncrement(int steps, Qt::KeyboardModifiers modifiers)
+    {
+        eventModifiers=modifiers;
+        hasEventModifiers=true;
+        increment(steps);
+        hasEventModifiers=false;
+    }
+    //power scale: the count+1 positions of the scale are computed once, already rounded to the displayed decimals and without duplicates
+    //so that stepping is a list lookup (and exactly reversible) and the progress is interpolated from the normalized positions
+    struct PowerTable
+    {
+        QVector<double> values, progress;
+    };
+    static PowerTable powerTable(int count, double min, double max, double power, double decimalScale)
+    {
+        PowerTable table;
+        if(count<=0 || !(min<max))
+            return table;
+        table.values.reserve(count+1);
+        table.progress.reserve(count+1);
+        for(int i=0; i<=count; i++)
+        {
+            double normalizedValue=double(i)/double(count);
+            double value=roundedValue(pow(normalizedValue,power)*(max-min)+min,decimalScale);
+            if(!table.values.isEmpty() && value<=table.values.last())
+                continue;
+            table.values.append(value);
+            table.progress.append(normalizedValue);
+        }
+        return table;
+    }
+    void refreshPowerTables()
+    {
+        countTable=powerTable(m_count,min,max,m_power,decimalScale);
+        ctrlCountTable=ctrlCount==m_count?countTable:powerTable(ctrlCount,min,max,m_power,decimalScale);
+    }
+    //inside [min,max] the steps are table lookups, beyond a non-strict min or max the scale is extended with the pow step (mirrored below min)
+    static double powerValue(double normalizedValue, double min, double max, double power) {return (normalizedValue<0.?-pow(-normalizedValue,power):pow(normalizedValue,power))*(max-min)+min;}
+    static double powerNormalizedValue(double value, double min, double max, double power) {double normalizedValue=(value-min)/(max-min); return normalizedValue<0.?-pow(-normalizedValue,1./power):pow(normalizedValue,1./power);}
+    static double powerSteppedValue(const PowerTable &table, int count, double min, double max, double power, bool extendMin, bool extendMax, double value, int steps, double decimalScale, int &hint)
+    {
+        const QVector<double> &values=table.values;
+        double tolerance=0.5/decimalScale;
+        if(values.isEmpty() || steps==0)
+            return value;
+        bool outside=(extendMin && value<values.first()-tolerance) || (extendMax && value>values.last()+tolerance);
+        if(!outside)
+        {
+            int index=steppedIndex(values,value,steps,tolerance,hint);
+            if(!(extendMin && index<0) && !(extendMax && index>=values.count()))
+            {
+                hint=qBound(0,index,values.count()-1);
+                return values[hint];
+            }
+            //remaining steps beyond the table end
+            value=index<0?values.first():values.last();
+            steps=index<0?index:index-(values.count()-1);
+        }
+        hint=-1;
+        double newValue=roundedValue(powerValue(powerNormalizedValue(value,min,max,power)+double(steps)/double(count),min,max,power),decimalScale);
+        //at least one displayed decimal per step
+        return steps>0?qMax(newValue,roundedValue(value+double(steps)/decimalScale,decimalScale)):qMin(newValue,roundedValue(value+double(steps)/decimalScale,decimalScale));
+    }
+    static double powerProgress(const PowerTable &table, double value)
+    {
+        int i=upperValueIndex(table.values,value,0.);
+        if(i==0) return 0.;
+        if(i==table.values.count()) return 1.;
+        return table.progress[i-1]+(table.progress[i]-table.progress[i-1])*(value-table.values[i-1])/(table.values[i]-table.values[i-1]);
+    }
+    static double roundedValue(double value, double decimalScale) {return qAbs(value*decimalScale)<1e15?std::round(value*decimalScale)/decimalScale:value;}
+    double roundedValue(double value) {return roundedValue(value,decimalScale);}
+    void revalidate() {textAcceptable=false; if(batchDepth) pendingValidate=true; else finishEditing();}
+    void requestUpdate() {if(batchDepth) pendingUpdate=true; else update();}
+    //clears the increment method, the text completer is kept when it is about to be reused for a new text list
+    void resetIncrement(bool incrementable, bool keepCompleter=false)
+    {
+        this->incrementable=incrementable;
+        setMouseTracking(incrementable);
+        m_step=ctrlStep=0.; m_count=ctrlCount=0;
+        countTable=ctrlCountTable=PowerTable();
+        m_valueList.clear(); m_valueCtrlList.clear(); m_textList.clear(); textIndex.clear(); m_domain.clear();
+        validator.setValueList();
+        if(!keepCompleter) {delete textCompleter; textCompleter=0; textModel=0;}
+    }
+    void parseText(const QString &text) {m_value=parseValue(text,&m_valueValid); textAcceptable=false;}
+    //value type hooks - formatting, parsing and linear stepping of the value, specialized by QLineEditExtT
+    virtual QString formatValue(double value) {return QString::number(value,'f',decimals);}
+    virtual double parseValue(const QString &text, bool *ok) {return text.toDouble(ok);}
+    virtual double linearSteppedValue(double value, int steps, double step) {return value+double(steps)*step;}
+    void publishValue(bool committed) {if(output && m_valueValid && (committed || publishIntermediate)) output->publish(m_value,QValueOutput::now(),committed);}
+    void onTextChanged(const QString &text) {
+        QLINEEDITEXT_COUNT(m_stats,TextChanges);
+        textWidth=-1;
+        if(!settingText) parseText(text);
+        if((!prefix.isEmpty() || !suffix.isEmpty()) && !(alignment()&Qt::AlignTrailing)) update(); //prefix/suffix follow the text
+        else updateProgress();
+    }
+
     void focusInEvent(QFocusEvent * event)
     {
+        ensureTextCompleter();
         if(event->reason()!=Qt::MouseFocusReason)
         {
             setReadOnly(false);
@@ -205,15 +1069,17 @@ protected:
 
     void keyPressEvent(QKeyEvent * event)
     {
-        if(event->key()==Qt::Key_Up) increment();
-        if(event->key()==Qt::Key_Down) decrement();
+        if(event->key()==Qt::Key_Up) inputIncrement(1,event->modifiers());
+        if(event->key()==Qt::Key_Down) inputIncrement(-1,event->modifiers());
         QLineEdit::keyPressEvent(event);
     }
     void wheelEvent(QWheelEvent * event)
     {
+        //one step per wheel notch (120), a step is triggered from half a notch and the remainder is kept for high resolution wheels
         wheelSum+=event->angleDelta().y()-event->angleDelta().x();
-        if(wheelSum>=60) {increment(); wheelSum=0;}
-        if(wheelSum<=-60) {decrement(); wheelSum=0;}
+        int steps=(wheelSum+(wheelSum>0?60:-60))/120;
+        wheelSum-=steps*120;
+        inputIncrement(steps,event->modifiers());
         QLineEdit::wheelEvent(event);
     }
 
@@ -229,8 +1095,11 @@ protected:
         {
             setReadOnly(false);
             selectAll();
-            if(!m_textList.isEmpty() && completer())
-                completer()->complete();
+            if(!m_textList.isEmpty() && ensureTextCompleter())
+            {
+                textModel->setFilter(QString());
+                textCompleter->complete();
+            }
             QLineEdit::mouseReleaseEvent(event);
         }
     }
@@ -242,8 +1111,7 @@ protected:
             {
                 QPoint dragD=event->pos()-dragStart;
                 int newIncrement=(dragD.x()-dragD.y())/dragStep;
-                if(newIncrement-lastIncrement>0) increment();
-                if(newIncrement-lastIncrement<0) decrement();
+                inputIncrement(newIncrement-lastIncrement,event->modifiers());
                 lastIncrement=newIncrement;
             }
         } else
@@ -293,6 +1161,14 @@ protected:
                 dragStep=mouseDragStep;
             return true;
         }
+        case QEvent::Polish:
+        {
+            //the background capture and the font metrics dependent layout are deferred until the widget is polished (just before it is first shown), with its final palette and font
+            bool result=QLineEdit::event(event);
+            refreshBackground();
+            if(pendingLayout && !batchDepth) {pendingLayout=false; refreshLayout();}
+            return result;
+        }
         default:
             return QLineEdit::event(event);;
         }
@@ -302,74 +1178,59 @@ protected:
         refreshLayout();
         QLineEdit::resizeEvent(event);
     }
+    void changeEvent(QEvent *event)
+    {
+        switch(event->type()) {
+        case QEvent::FontChange:
+            textWidth=-1;
+            refreshLayout();
+            break;
+        case QEvent::PaletteChange:
+        case QEvent::StyleChange:
+            refreshBackground();
+            break;
+        default:
+            break;
+        }
+        QLineEdit::changeEvent(event);
+    }
     void paintEvent(QPaintEvent *event)
     {
+        QLINEEDITEXT_COUNT(m_stats,Paints);
+        QLINEEDITEXT_TIME(m_stats,PaintTimer,"paint");
         int topMargin=contentsMargins().top();
         int bottomMargin=contentsMargins().bottom();
         int leftMargin=contentsMargins().left();
         int rightMargin=contentsMargins().right();
         int contentsWidth=width()-leftMargin-rightMargin;
+        int contentsHeight=height()-(topMargin+bottomMargin);
         if(progress)
         {
-            if(palette().color(QPalette::Window).rgba()!=0)
-            {
-                backgroundColor=palette().color(QPalette::Window);
-                setStyleSheet(styleSheet()+" QLineEdit{background: rgba(0,0,0,0);}");
-            }
-
             QPainter painter(this);
             painter.setRenderHint(QPainter::Antialiasing, false);
-            double progressValue=0.;
-            if(m_step!=0.)
-                progressValue=qBound(0.,(value()-min)/(max-min),1.);
-            if(m_count!=0.)
-                progressValue=qBound(0.,pow((value()-min)/(max-min),1./m_power),1.);
-            if(!m_valueList.isEmpty())
-            {
-                int i;
-                for(i=0; i<m_valueCtrlList.count(); i++)
-                    if(m_valueCtrlList[i]>=value()) {break;}
-                progressValue=double(i)/double(m_valueCtrlList.count()-1);
-            }
-            if(!m_textList.isEmpty())
-                progressValue=double(m_textList.indexOf(text()))/double(m_textList.count()-1);
-            if(forcedProgress>=0.) progressValue=qMin(forcedProgress,1.);
-
-            painter.fillRect(leftMargin,topMargin,contentsWidth,height()-(topMargin+bottomMargin),backgroundColor);
-            painter.fillRect(leftMargin,topMargin,contentsWidth,height()-(topMargin+bottomMargin),backgroundColor);
-            painter.fillRect(leftMargin,topMargin,qRound(double(contentsWidth)*progressValue),height()-(topMargin+bottomMargin),palette().color(QPalette::AlternateBase));
+            paintedProgressWidth=progressWidth();
+            painter.fillRect(leftMargin+paintedProgressWidth,topMargin,contentsWidth-paintedProgressWidth,contentsHeight,backgroundColor);
+            painter.fillRect(leftMargin,topMargin,paintedProgressWidth,contentsHeight,palette().color(QPalette::AlternateBase));
         }
 
-        QFontMetrics metrics(font());
-        int prefixWidth=metrics.width(prefix)+prefixMargin;
-        int textWidth=metrics.width(text());
-        int suffixWidth=metrics.width(suffix)+suffixMargin;
-        int center=prefixWidth+(contentsWidth-prefixWidth-suffixWidth)/2;
-
         QLineEdit::paintEvent(event);
 
-        if(!prefix.isEmpty())
-        {
-            QPainter painter(this);
-            painter.setPen(QPen(palette().color(QPalette::Foreground)));
-            if(alignment()&(Qt::AlignLeading|Qt::AlignTrailing))
-                painter.drawText(QRect(leftMargin,topMargin,prefixWidth,height()-(topMargin+bottomMargin)), Qt::AlignLeading|(alignment()&Qt::AlignVertical_Mask), prefix);
-            if(alignment()&Qt::AlignHCenter)
-                painter.drawText(QRect(leftMargin+center-textWidth/2-prefixWidth,topMargin,prefixWidth,height()-(topMargin+bottomMargin)), Qt::AlignLeading|(alignment()&Qt::AlignVertical_Mask), prefix);
-        }
-        if(!suffix.isEmpty())
-        {
-            QPainter painter(this);
-            painter.setPen(QPen(palette().color(QPalette::Foreground)));
-            if(alignment()&Qt::AlignLeading)
-                painter.drawText(QRect(leftMargin+prefixWidth+textWidth,topMargin,suffixWidth,height()-(topMargin+bottomMargin)), Qt::AlignTrailing|(alignment()&Qt::AlignVertical_Mask), suffix);
-            if(alignment()&Qt::AlignHCenter)
-                painter.drawText(QRect(leftMargin+center+textWidth/2,topMargin,suffixWidth,height()-(topMargin+bottomMargin)), Qt::AlignTrailing|(alignment()&Qt::AlignVertical_Mask), suffix);
-            if(alignment()&Qt::AlignTrailing)
-                painter.drawText(QRect(width()-suffixWidth-rightMargin,topMargin,suffixWidth,height()-(topMargin+bottomMargin)), Qt::AlignTrailing|(alignment()&Qt::AlignVertical_Mask), suffix);
-        }
+        if(prefix.isEmpty() && suffix.isEmpty())
+            return;
+        if(textWidth<0)
+            textWidth=QFontMetrics(font()).width(text());
+
+        QPainter painter(this);
+        forEachDecoration(QRect(leftMargin,topMargin,contentsWidth,contentsHeight),alignment(),prefixWidth,textWidth,suffixWidth,[&](bool isPrefix, const QRect &rect){
+            if(isPrefix && !prefix.isEmpty())
+                drawDecoration(painter,rect,prefixCache,prefix,Qt::AlignLeading|(alignment()&Qt::AlignVertical_Mask),event->rect());
+            if(!isPrefix && !suffix.isEmpty())
+                drawDecoration(painter,rect,suffixCache,suffix,Qt::AlignTrailing|(alignment()&Qt::AlignVertical_Mask),event->rect());
+        });
     }
 private:
+    friend class QLineEditExtDelegate;
+
     class QValidatorExt : public QValidator
     {
     public:
@@ -378,71 +1239,284 @@ private:
             min=max=0.;
             minStrict=maxStrict=listStrict=true;
             decimals=0;
+            decimalScale=1.;
+            tolerance=0.5;
+            refreshChecks();
         }
-        void setRange(double min, double max, int decimals, bool minStrict, bool maxStrict) {this->min=min; this->max=max; this->decimals=decimals; this->minStrict=minStrict; this->maxStrict=maxStrict;}
-        void setValueList(QList<double> list=QList<double>(), bool strict=true) {this->valueList=list; this->listStrict=strict; this->textList.clear();}
-        void setTextList(QStringList list=QStringList(), bool strict=true) {this->textList=list; this->listStrict=strict; this->valueList.clear();}
+        void setRange(double min, double max, int decimals, bool minStrict, bool maxStrict) {this->min=min; this->max=max; this->decimals=decimals; this->minStrict=minStrict; this->maxStrict=maxStrict; decimalScale=pow(10.,double(decimals)); tolerance=0.5/decimalScale; refreshChecks();}
+        void setValueList(QVector<double> list=QVector<double>(), bool strict=true) {this->valueList=list; this->listStrict=strict; this->textIndex.clear(); refreshChecks();}
+        void setTextList(QSharedPointer<const QTextListIndex> index, bool strict=true) {this->textIndex=index; this->listStrict=strict; this->valueList.clear(); refreshChecks();}
+
+        //the input is parsed once per validate/fixup call, without allocation (toDouble converts through a stack buffer)
+        struct Input
+        {
+            double value;
+            bool isNumber;
+        };
+        static Input parse(const QString &text) {Input input; input.value=text.toDouble(&input.isNumber); return input;}
+
+        //on every keystroke, setText and finishEditing - the accepted input goes through a single parse and the precomputed checks, or a single hash lookup for text lists
         QValidator::State validate(QString &input, int &pos) const
         {
-            if(min<max && minStrict && input.toDouble()<min) return QValidator::Intermediate;
-            if(min<max && maxStrict && input.toDouble()>max) return QValidator::Intermediate;
-            if(!valueList.isEmpty() && listStrict && !valueList.contains(input.toDouble())) return QValidator::Intermediate;
-            if(!textList.isEmpty() && listStrict && !textList.contains(input)) return QValidator::Intermediate;
+            QLINEEDITEXT_COUNT(static_cast<QLineEditExt*>(parent())->m_stats,Validates);
+            if(numericChecks)
+            {
+                Input parsed=parse(input);
+                if(minBounded && parsed.value<min) return QValidator::Intermediate;
+                if(maxBounded && parsed.value>max) return QValidator::Intermediate;
+                if(strictValues && !isListEntry(input,parsed.value)) return QValidator::Intermediate;
+            }
+            if(strictTexts && !textIndex->contains(input)) return QValidator::Intermediate;
             return QValidator::Acceptable;
         }
 
-        void fixup(QString &input) const
+        //numeric part of fixup, so that setValue doesn't need to go through the text
+        double fixupValue(double value) const
         {
-            if(min<max && minStrict) input=QString::number(qMax(min,input.toDouble()),'f',decimals);
-            if(min<max && maxStrict) input=QString::number(qMin(max,input.toDouble()),'f',decimals);
-            if(!valueList.isEmpty() && listStrict)
+            if(minBounded) value=qMax(min,value);
+            if(maxBounded) value=qMin(max,value);
+            if(strictValues)
             {
-                for(int i=0; i<=valueList.count(); i++)
-                {
-                    if(i<valueList.count() && input.toDouble()<valueList[i]) {input=QString::number(valueList[qMax(i-1,0)],'f',decimals); break;}
-                    else if(i==valueList.count()) input=QString::number(qMin(max,valueList.last()),'f',decimals);
-                }
+                int i=upperValueIndex(valueList,value,tolerance);
+                value=i<valueList.count()?valueList[qMax(i-1,0)]:qMin(max,valueList.last());
             }
-            if(!textList.isEmpty() && listStrict)
+            return value;
+        }
+
+        //the replacement text is only built when the fixed up value or text differs from the input
+        void fixup(QString &input) const
+        {
+            QLINEEDITEXT_COUNT(static_cast<QLineEditExt*>(parent())->m_stats,Fixups);
+            if(numericChecks)
             {
-                for(int i=0; i<=textList.count(); i++)
-                {
-                    if(i<textList.count() && textList[i].toLower().contains(input.toLower())){input=textList[i]; break;}
-                    else if(i==textList.count()) input=textList.first();
-                }
+                Input parsed=parse(input);
+                double value=fixupValue(parsed.value);
+                if(!parsed.isNumber || value!=parsed.value || (strictValues && !isFormatted(input)))
+                    input=QString::number(value,'f',decimals);
             }
+            if(strictTexts && !textIndex->contains(input))
+                input=textIndex->text(qMax(textIndex->findFirst(input),0));
         }
     private:
+        //a strict list only accepts its entries as displayed - the tolerance finds the matching entry, which the input must be formatted as
+        bool isListEntry(const QString &input, double value) const
+        {
+            int i=lowerValueIndex(valueList,value,tolerance);
+            if(i>=valueList.count() || valueList[i]>value+tolerance) return false;
+            return value==roundedValue(valueList[i],decimalScale) && isFormatted(input);
+        }
+        //same as comparing with QString::number(value,'f',decimals), without building the string
+        bool isFormatted(const QString &input) const
+        {
+            int i=0, size=input.size();
+            if(i<size && input[i]=='-') i++;
+            int integerStart=i;
+            while(i<size && input[i].isDigit()) i++;
+            if(i==integerStart || (i-integerStart>1 && input[integerStart]=='0')) return false;
+            if(decimals<=0) return i==size;
+            if(i>=size || input[i]!='.') return false;
+            int fractionStart=++i;
+            while(i<size && input[i].isDigit()) i++;
+            return i==size && i-fractionStart==decimals;
+        }
+
+        void refreshChecks()
+        {
+            minBounded=min<max && minStrict;
+            maxBounded=min<max && maxStrict;
+            strictValues=!valueList.isEmpty() && listStrict;
+            strictTexts=textIndex && !textIndex->isEmpty() && listStrict;
+            numericChecks=minBounded || maxBounded || strictValues;
+        }
+
         double min, max;
         bool minStrict, maxStrict;
         int decimals;
+        double decimalScale;
+        double tolerance;
 
-        QList<double> valueList;
-        QStringList textList;
+        QVector<double> valueList;
+        QSharedPointer<const QTextListIndex> textIndex;
         bool listStrict;
+
+        bool minBounded, maxBounded, strictValues, strictTexts, numericChecks;
+    };
+
+    //the progress bar paints the background itself, so the QLineEdit background is made transparent once here rather than on every paint
+    //the background color is only captured once the widget is polished (parent and application stylesheets applied), otherwise at the Polish event
+    void refreshBackground() {
+        if(!progress || updatingStyle || !testAttribute(Qt::WA_WState_Polished) || palette().color(QPalette::Window).rgba()==0)
+            return;
+        backgroundColor=palette().color(QPalette::Window);
+        const QString transparentStyle=" QLineEdit{background: rgba(0,0,0,0);}";
+        if(!styleSheet().contains(transparentStyle))
+        {
+            updatingStyle=true;
+            setStyleSheet(styleSheet()+transparentStyle);
+            updatingStyle=false;
+        }
+    }
+
+    //value lists are sorted and without duplicates (see QValueDomain), so that lookups are binary searches
+    //the tolerance is half of the smallest displayed decimal, so that a displayed (rounded) value still matches its list entry
+    static int upperValueIndex(const QVector<double> &list, double value, double tolerance) {return int(std::upper_bound(list.constBegin(),list.constEnd(),value+tolerance)-list.constBegin());}
+    static int lowerValueIndex(const QVector<double> &list, double value, double tolerance) {return int(std::lower_bound(list.constBegin(),list.constEnd(),value-tolerance)-list.constBegin());}
+
+    //steps through a value list, starting from the last reached index (hint) when it still matches the current value
+    static double steppedValue(const QVector<double> &list, double value, int steps, double tolerance, int &hint) {
+        hint=qBound(0,steppedIndex(list,value,steps,tolerance,hint),list.count()-1);
+        return list[hint];
+    }
+    //unbounded index of the stepped value, before or past the list ends when stepping beyond them
+    static int steppedIndex(const QVector<double> &list, double value, int steps, double tolerance, int hint) {
+        if(hint>=0 && hint<list.count() && qAbs(list[hint]-value)<=tolerance)
+            return hint+steps;
+        if(steps>0)
+            return upperValueIndex(list,value,tolerance)+steps-1;
+        return lowerValueIndex(list,value,tolerance)+steps;
+    }
+    double steppedListValue(const QVector<double> &list, int steps) {return steppedValue(list,value(),steps,0.5/decimalScale,valueIndex);}
+
+    //progress bar
+    double progressValue() {
+        double progressValue=0.;
+        if(m_step!=0.)
+            progressValue=qBound(0.,(value()-min)/(max-min),1.);
+        if(m_count!=0.)
+            progressValue=qBound(0.,powerProgress(ctrlCount>m_count?ctrlCountTable:countTable,value()),1.);
+        if(!m_valueList.isEmpty())
+        {
+            int i=lowerValueIndex(m_valueCtrlList,value(),0.5/decimalScale);
+            progressValue=double(qMin(i,m_valueCtrlList.count()-1))/double(qMax(m_valueCtrlList.count()-1,1));
+        }
+        if(!m_textList.isEmpty())
+            progressValue=double(textIndex->indexOf(text()))/double(qMax(m_textList.count()-1,1));
+        if(forcedProgress>=0.) progressValue=qMin(forcedProgress,1.);
+        return progressValue;
+    }
+    int progressWidth() {
+        int contentsWidth=width()-contentsMargins().left()-contentsMargins().right();
+        return qRound(double(contentsWidth)*progressValue());
+    }
+    //only invalidate the strip between the painted and the new progress extent
+    void updateProgress() {
+        if(!progress)
+            return;
+        int newWidth=progressWidth();
+        if(paintedProgressWidth<0)
+            update();
+        else if(newWidth!=paintedProgressWidth)
+            update(QRect(contentsMargins().left()+qMin(newWidth,paintedProgressWidth),contentsMargins().top(),qAbs(newWidth-paintedProgressWidth),height()-contentsMargins().top()-contentsMargins().bottom()));
+    }
+
+    //prefix/suffix placement around the text for the given contents rect and alignment, calls visit(isPrefix, rect) for each place to draw them
+    template<typename Visitor> static void forEachDecoration(const QRect &contents, Qt::Alignment alignment, int prefixWidth, int textWidth, int suffixWidth, Visitor visit) {
+        int center=prefixWidth+(contents.width()-prefixWidth-suffixWidth)/2;
+        if(alignment&(Qt::AlignLeading|Qt::AlignTrailing))
+            visit(true,QRect(contents.left(),contents.top(),prefixWidth,contents.height()));
+        if(alignment&Qt::AlignHCenter)
+            visit(true,QRect(contents.left()+center-textWidth/2-prefixWidth,contents.top(),prefixWidth,contents.height()));
+        if(alignment&Qt::AlignLeading)
+            visit(false,QRect(contents.left()+prefixWidth+textWidth,contents.top(),suffixWidth,contents.height()));
+        if(alignment&Qt::AlignHCenter)
+            visit(false,QRect(contents.left()+center+textWidth/2,contents.top(),suffixWidth,contents.height()));
+        if(alignment&Qt::AlignTrailing)
+            visit(false,QRect(contents.left()+contents.width()-suffixWidth,contents.top(),suffixWidth,contents.height()));
+    }
+
+    //prefix/suffix are rendered once into a pixmap, re-rendered only when their text, size, font, color or device pixel ratio change
+    struct DecorationCache
+    {
+        QString text;
+        QSize size;
+        int flags;
+        QFont font;
+        QRgb color;
+        qreal dpr;
+        QPixmap pixmap;
     };
+    void drawDecoration(QPainter &painter, const QRect &rect, DecorationCache &cache, const QString &text, int flags, const QRect &exposed) {
+        if(rect.isEmpty() || !rect.intersects(exposed))
+            return;
+        QRgb color=palette().color(QPalette::Foreground).rgba();
+        qreal dpr=devicePixelRatioF();
+        if(cache.pixmap.isNull() || cache.text!=text || cache.size!=rect.size() || cache.flags!=flags || cache.color!=color || cache.dpr!=dpr || cache.font!=font())
+        {
+            cache.text=text; cache.size=rect.size(); cache.flags=flags; cache.color=color; cache.dpr=dpr; cache.font=font();
+            cache.pixmap=QPixmap(rect.size()*dpr);
+            cache.pixmap.setDevicePixelRatio(dpr);
+            cache.pixmap.fill(Qt::transparent);
+            QPainter pixmapPainter(&cache.pixmap);
+            pixmapPainter.setPen(QPen(QColor::fromRgba(color)));
+            pixmapPainter.setFont(font());
+            pixmapPainter.drawText(QRect(QPoint(0,0),rect.size()),flags,text);
+        }
+        painter.drawPixmap(rect.topLeft(),cache.pixmap);
+    }
+
+    //the completer isn't installed with setCompleter, its popup is driven from textEdited with the indexed model
+    //the completer, its model and popup are only created for the widgets that get focused or edited
+    bool ensureTextCompleter() {
+        if(!textCompleter && textIndex && !textIndex->isEmpty()) createTextCompleter();
+        return textCompleter!=0;
+    }
+    void createTextCompleter() {
+        textCompleter=new QCompleter(this);
+        textModel=new QTextListModel(textIndex,textCompleter);
+        textModel->setThreaded(threadedCompletion);
+        textCompleter->setModel(textModel);
+        textCompleter->setWidget(this);
+        textCompleter->setCaseSensitivity(Qt::CaseInsensitive);
+        textCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+        textCompleter->setMaxVisibleItems(10);
+        textCompleter->setWrapAround(false);
+        if(QListView *view=qobject_cast<QListView*>(textCompleter->popup()))
+            view->setUniformItemSizes(true);
+        connect(textCompleter, static_cast<void(QCompleter::*)(const QString &)>(&QCompleter::activated),[=](const QString &text){setText(text); finishEditing(); emit editingFinished();});
+        connect(textModel,&QAbstractItemModel::rowsInserted,[=](){if(hasFocus() && !textCompleter->popup()->isVisible()) textCompleter->complete();});
+        refreshCompleterStyle();
+    }
+    void refreshCompleterStyle() {
+        if(textCompleter && (!prefix.isEmpty() || !suffix.isEmpty()))
+            textCompleter->popup()->setStyleSheet(QString("padding-left: %1px; padding-right: %2px; text-align: %3;").arg(prefixWidth).arg(suffixWidth).arg(alignment()&Qt::AlignLeading?"left":(alignment()&Qt::AlignTrailing?"right":"center")));
+    }
 
     void refreshLayout() {
+        if(batchDepth || !testAttribute(Qt::WA_WState_Polished)) {pendingLayout=true; return;}
         QFontMetrics metrics(font());
-        int prefixWidth=metrics.width(prefix)+prefixMargin;
-        int suffixWidth=metrics.width(suffix)+suffixMargin;
+        prefixWidth=metrics.width(prefix)+prefixMargin;
+        suffixWidth=metrics.width(suffix)+suffixMargin;
         if(!prefix.isEmpty() || !suffix.isEmpty())
         {
             setTextMargins(prefixWidth,0,suffixWidth,0);
-            if(completer())
-                completer()->popup()->setStyleSheet(QString("padding-left: %1px; padding-right: %2px; text-align: %3;").arg(prefixWidth).arg(suffixWidth).arg(alignment()&Qt::AlignLeading?"left":(alignment()&Qt::AlignTrailing?"right":"center")));
+            refreshCompleterStyle();
         }
     }
 
     double min, max;
     bool minStrict, maxStrict;
     int decimals;
+    double decimalScale;
+
+    double m_value;
+    bool m_valueValid;
+    bool textAcceptable, settingText;
 
     double m_step, ctrlStep;
     int m_count, ctrlCount;
     double m_power;
-    QList<double> m_valueList, m_valueCtrlList;
+    PowerTable countTable, ctrlCountTable;
+    QVector<double> m_valueList, m_valueCtrlList;
+    int valueIndex;
     QStringList m_textList;
+    QSharedPointer<const QTextListIndex> textIndex;
+    QSharedPointer<const QValueDomain> m_domain;
+    QCompleter *textCompleter;
+    QTextListModel *textModel;
+    bool threadedCompletion;
+
+    int batchDepth;
+    bool pendingValidate, pendingLayout, pendingUpdate;
     bool listStrict;
     bool incrementable;
 
@@ -453,17 +1527,352 @@ private:
     QPoint dragStart;
     int lastIncrement;
     int wheelSum;
+    bool coalesceIncrements, incrementScheduled;
+    int pendingSteps;
+    Qt::KeyboardModifiers eventModifiers, pendingModifiers;
+    bool hasEventModifiers;
     bool usingTouchKeyboard;
     IncrementDiff m_incrementDiff;
 
     bool progress;
     double forcedProgress;
 
+    QSharedPointer<Feed> m_feed;
+    QElapsedTimer feedTimer;
+
+    QValueOutput *output;
+#ifdef QLINEEDITEXT_INSTRUMENTATION
+    QLineEditExtStats m_stats;
+#endif
+    bool publishIntermediate;
+
     QString prefix, suffix;
     int prefixMargin, suffixMargin;
+    int prefixWidth, suffixWidth, textWidth;
+    bool updatingStyle;
+    int paintedProgressWidth;
+    DecorationCache prefixCache, suffixCache;
 
     QValidatorExt validator;
     QColor backgroundColor;
 };
 
+//QLineEditExt with a compile-time value type - QLineEditExtT<int>, QLineEditExtT<qint64>, QLineEditExtT<QDecimal<N> > (N decimals) or QLineEditExtT<double>
+//the typed setters and value() convert from/to the double of QLineEditExt, and the value is formatted, parsed and linearly stepped by the QValueTraits of T,
+//exact as long as the value fits in the 53 bits mantissa of the double (integers up to 2^53, QDecimal units up to 2^53)
+template<typename T> class QLineEditExtT : public QLineEditExt
+{
+public:
+    typedef QValueTraits<T> Traits;
+
+    //the decimals of T apply from the start, so that values are rounded to them even without a range
+    QLineEditExtT(QWidget * parent = 0) : QLineEditExt(parent) {initValue();}
+    QLineEditExtT(const QString & contents, QWidget * parent = 0) : QLineEditExt(contents, parent) {initValue();}
+
+    //the number of decimals is the one of T, only QLineEditExtT<double> uses the decimals argument
+    void setRange(T min, T max, int decimals=0, bool minStrict=true, bool maxStrict=true) {QLineEditExt::setRange(Traits::toDouble(min),Traits::toDouble(max),Traits::decimals<0?decimals:Traits::decimals,minStrict,maxStrict);}
+    void setStep(T step, T ctrlStep=T()) {QLineEditExt::setStep(Traits::toDouble(step),Traits::toDouble(ctrlStep));}
+    void setDefaultValue(T value) {QLineEditExt::setDefaultValue(Traits::toDouble(value));}
+    void setValue(T value) {QLineEditExt::setValue(Traits::toDouble(value));}
+    T value() {return Traits::fromDouble(QLineEditExt::value());}
+
+protected:
+    QString formatValue(double value) {return Traits::decimals<0 || qIsNaN(value)?QLineEditExt::formatValue(value):Traits::toString(Traits::fromDouble(value),Traits::decimals);}
+    double parseValue(const QString &text, bool *ok) {return Traits::toDouble(Traits::parse(text,ok));}
+    double linearSteppedValue(double value, int steps, double step) {return Traits::toDouble(Traits::add(Traits::fromDouble(value),Traits::fromDouble(step),steps));}
+
+private:
+    //the base constructor parsed the contents before the hooks above were active, so they are parsed again by T and formatted through setValue
+    //(QLineEditExtT<double> parses and formats like QLineEditExt, its decimals are only known once setRange is called)
+    void initValue()
+    {
+        if(Traits::decimals<0) return;
+        if(Traits::decimals>0) QLineEditExt::setRange(0.,0.,Traits::decimals);
+        parseText(text());
+        if(valueIsValid()) QLineEditExt::setValue(QLineEditExt::value());
+    }
+};
+
+//Widget-less QLineEditExt for item views - each cell is painted (progress bar, prefix/suffix) and incremented by mouse drag (and optionally wheel)
+//from the model roles below, and a real QLineEditExt editor is only created for the cell being text-edited
+//the value (or text) is read from and written to Qt::EditRole, attach() installs the delegate on a view and enables the drag/wheel increments
+class QLineEditExtDelegate : public QStyledItemDelegate
+{
+public:
+    enum Role
+    {
+        MinimumRole=Qt::UserRole+0x1000,
+        MaximumRole,
+        DecimalsRole,
+        StepRole,
+        CtrlStepRole,
+        CountRole,
+        CtrlCountRole,
+        PowerRole,
+        DomainRole, //QSharedPointer<const QValueDomain>
+        PrefixRole,
+        SuffixRole,
+        ProgressRole, //bool
+        ForcedProgressRole, //from 0 to 1
+        MinimumStrictRole, //bool, strict when not set
+        MaximumStrictRole, //bool, strict when not set
+    };
+
+    QLineEditExtDelegate(QObject * parent = 0) : QStyledItemDelegate(parent)
+    {
+        view=0;
+        dragStep=8;
+        wheelIncrement=false;
+        wheelSum=0;
+        lastIncrement=0;
+        valueIndex=-1;
+        pressed=dragged=false;
+    }
+
+    void attach(QAbstractItemView *view) {this->view=view; view->setItemDelegate(this); view->viewport()->installEventFilter(this);}
+    void setIncrementDragDistance(int mouse=8) {dragStep=mouse;}
+    //off by default so that the wheel keeps scrolling the view
+    void setWheelIncrement(bool increment=true) {wheelIncrement=increment;}
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    {
+        QStyleOptionViewItem opt=option;
+        initStyleOption(&opt,index);
+        opt.text.clear();
+        const QWidget *widget=opt.widget;
+        QStyle *style=widget?widget->style():QApplication::style();
+        style->drawControl(QStyle::CE_ItemViewItem,&opt,painter,widget);
+
+        QRect contents=opt.rect;
+        painter->save();
+        if(index.data(ProgressRole).toBool())
+            painter->fillRect(contents.left(),contents.top(),qRound(double(contents.width())*progressValue(index)),contents.height(),opt.palette.color(QPalette::AlternateBase));
+
+        QString text=cellText(index);
+        QString prefix=index.data(PrefixRole).toString();
+        QString suffix=index.data(SuffixRole).toString();
+        if(!prefix.isEmpty()) prefix+=" ";
+        if(!suffix.isEmpty()) suffix=" "+suffix;
+        QFontMetrics metrics(opt.font);
+        int prefixWidth=metrics.width(prefix);
+        int suffixWidth=metrics.width(suffix);
+        int textWidth=metrics.width(text);
+        Qt::Alignment alignment=opt.displayAlignment;
+
+        painter->setFont(opt.font);
+        painter->setPen(opt.palette.color(opt.state&QStyle::State_Selected?QPalette::HighlightedText:QPalette::Text));
+        painter->drawText(QRect(contents.left()+prefixWidth,contents.top(),contents.width()-prefixWidth-suffixWidth,contents.height()),alignment,text);
+        QLineEditExt::forEachDecoration(contents,alignment,prefixWidth,textWidth,suffixWidth,[&](bool isPrefix, const QRect &rect){
+            if(isPrefix && !prefix.isEmpty())
+                painter->drawText(rect,Qt::AlignLeading|(alignment&Qt::AlignVertical_Mask),prefix);
+            if(!isPrefix && !suffix.isEmpty())
+                painter->drawText(rect,Qt::AlignTrailing|(alignment&Qt::AlignVertical_Mask),suffix);
+        });
+        painter->restore();
+    }
+
+    QWidget *createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+    {
+        QLineEditExt *editor=new QLineEditExt(parent);
+        QLineEditExt::Batch batch(editor);
+        editor->setAlignment(option.displayAlignment);
+        editor->setRange(roleValue(index,MinimumRole,0.),roleValue(index,MaximumRole,0.),index.data(DecimalsRole).toInt(),roleFlag(index,MinimumStrictRole,true),roleFlag(index,MaximumStrictRole,true));
+        QSharedPointer<const QValueDomain> domain=index.data(DomainRole).value<QSharedPointer<const QValueDomain> >();
+        if(domain)
+            editor->setDomain(domain);
+        else if(index.data(CountRole).toInt()>0)
+            editor->setCount(index.data(CountRole).toInt(),index.data(CtrlCountRole).toInt(),roleValue(index,PowerRole,2.));
+        else if(roleValue(index,StepRole,0.)>0.)
+            editor->setStep(roleValue(index,StepRole,0.),roleValue(index,CtrlStepRole,0.));
+        editor->setPrefix(index.data(PrefixRole).toString());
+        editor->setSuffix(index.data(SuffixRole).toString());
+        editor->showProgress(index.data(ProgressRole).toBool());
+        return editor;
+    }
+    void setEditorData(QWidget *editor, const QModelIndex &index) const
+    {
+        QLineEditExt *edit=static_cast<QLineEditExt*>(editor);
+        if(isTextCell(index)) edit->setText(index.data(Qt::EditRole).toString());
+        else edit->setValue(index.data(Qt::EditRole).toDouble());
+    }
+    void setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+    {
+        QLineEditExt *edit=static_cast<QLineEditExt*>(editor);
+        if(isTextCell(index)) model->setData(index,edit->text(),Qt::EditRole);
+        else model->setData(index,edit->value(),Qt::EditRole);
+    }
+
+    //same stepping as QLineEditExt::increment, from the cell roles
+    QVariant steppedData(const QModelIndex &index, int steps, bool ctrl, int &hint) const
+    {
+        QVariant data=index.data(Qt::EditRole);
+        QSharedPointer<const QValueDomain> domain=index.data(DomainRole).value<QSharedPointer<const QValueDomain> >();
+        if(isTextCell(index))
+        {
+            QSharedPointer<const QTextListIndex> texts=domain->textIndex();
+            return texts->text(qBound(0,texts->indexOf(data.toString())+steps,texts->count()-1));
+        }
+        double min=roleValue(index,MinimumRole,0.), max=roleValue(index,MaximumRole,0.);
+        bool minStrict=roleFlag(index,MinimumStrictRole,true), maxStrict=roleFlag(index,MaximumStrictRole,true);
+        double decimalScale=pow(10.,index.data(DecimalsRole).toInt());
+        double step=roleValue(index,StepRole,0.), ctrlStep=roleValue(index,CtrlStepRole,0.);
+        int count=index.data(CountRole).toInt(), ctrlCount=index.data(CtrlCountRole).toInt();
+        double value=data.toDouble();
+        if(domain && !domain->values().isEmpty())
+            value=QLineEditExt::steppedValue(ctrl?domain->ctrlValues():domain->values(),value,steps,0.5/decimalScale,hint);
+        else if(count>0 && min<max)
+        {
+            int stepCount=ctrl && ctrlCount>0?ctrlCount:count;
+            value=QLineEditExt::powerSteppedValue(powerTable(index,stepCount),stepCount,min,max,roleValue(index,PowerRole,2.),!minStrict,!maxStrict,value,steps,decimalScale,hint);
+        }
+        else if(step>0.)
+            value+=double(steps)*(ctrl && ctrlStep>0.?ctrlStep:step);
+        else
+            return data;
+        if(min<max && minStrict) value=qMax(min,value);
+        if(min<max && maxStrict) value=qMin(max,value);
+        return QLineEditExt::roundedValue(value,decimalScale);
+    }
+    double progressValue(const QModelIndex &index) const
+    {
+        QVariant forced=index.data(ForcedProgressRole);
+        if(forced.isValid() && forced.toDouble()>=0.) return qMin(forced.toDouble(),1.);
+        QSharedPointer<const QValueDomain> domain=index.data(DomainRole).value<QSharedPointer<const QValueDomain> >();
+        if(isTextCell(index))
+        {
+            QSharedPointer<const QTextListIndex> texts=domain->textIndex();
+            return qMax(double(texts->indexOf(index.data(Qt::EditRole).toString())),0.)/double(qMax(texts->count()-1,1));
+        }
+        double value=index.data(Qt::EditRole).toDouble();
+        if(domain && !domain->ctrlValues().isEmpty())
+        {
+            int i=QLineEditExt::lowerValueIndex(domain->ctrlValues(),value,0.5*pow(10.,-index.data(DecimalsRole).toInt()));
+            return double(qMin(i,domain->ctrlValues().count()-1))/double(qMax(domain->ctrlValues().count()-1,1));
+        }
+        double min=roleValue(index,MinimumRole,0.), max=roleValue(index,MaximumRole,0.);
+        if(!(min<max)) return 0.;
+        int count=index.data(CountRole).toInt(), ctrlCount=index.data(CtrlCountRole).toInt();
+        if(count>0) return qBound(0.,QLineEditExt::powerProgress(powerTable(index,qMax(count,ctrlCount)),value),1.);
+        return qBound(0.,(value-min)/(max-min),1.);
+    }
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event)
+    {
+        if(view && object==view->viewport())
+        {
+            switch(event->type()) {
+            case QEvent::MouseButtonPress:
+            {
+                QMouseEvent *mouseEvent=(QMouseEvent*)event;
+                pressedIndex=view->indexAt(mouseEvent->pos());
+                pressed=mouseEvent->button()==Qt::LeftButton && isIncrementable(pressedIndex);
+                dragged=false;
+                dragStart=mouseEvent->pos();
+                lastIncrement=0;
+                valueIndex=-1;
+                break;
+            }
+            case QEvent::MouseMove:
+            {
+                QMouseEvent *mouseEvent=(QMouseEvent*)event;
+                if(!pressed || !(mouseEvent->buttons()&Qt::LeftButton) || !pressedIndex.isValid())
+                    break;
+                QPoint dragD=mouseEvent->pos()-dragStart;
+                int newIncrement=(dragD.x()-dragD.y())/dragStep;
+                if(newIncrement!=lastIncrement)
+                {
+                    increment(pressedIndex,newIncrement-lastIncrement,mouseEvent->modifiers());
+                    lastIncrement=newIncrement;
+                    dragged=true;
+                }
+                return true; //no selection change while dragging a value
+            }
+            case QEvent::MouseButtonRelease:
+                pressed=false;
+                if(dragged) {dragged=false; return true;}
+                break;
+            case QEvent::Wheel:
+            {
+                if(!wheelIncrement)
+                    break;
+                QWheelEvent *wheelEvent=(QWheelEvent*)event;
+                QModelIndex index=view->indexAt(wheelEvent->pos());
+                if(!isIncrementable(index))
+                    break;
+                wheelSum+=wheelEvent->angleDelta().y()-wheelEvent->angleDelta().x();
+                int steps=(wheelSum+(wheelSum>0?60:-60))/120;
+                wheelSum-=steps*120;
+                valueIndex=-1;
+                increment(index,steps,wheelEvent->modifiers());
+                return true;
+            }
+            default:
+                break;
+            }
+        }
+        return QStyledItemDelegate::eventFilter(object,event);
+    }
+
+private:
+    static double roleValue(const QModelIndex &index, int role, double defaultValue) {QVariant data=index.data(role); return data.isValid()?data.toDouble():defaultValue;}
+    static bool roleFlag(const QModelIndex &index, int role, bool defaultValue) {QVariant data=index.data(role); return data.isValid()?data.toBool():defaultValue;}
+
+    //power tables of the count cells, built once per scale and shared by all the cells using it
+    struct PowerScale
+    {
+        int count;
+        double min, max, power;
+        int decimals;
+        bool operator==(const PowerScale &other) const {return count==other.count && min==other.min && max==other.max && power==other.power && decimals==other.decimals;}
+        friend uint qHash(const PowerScale &scale, uint seed=0) {return qHash(scale.count,seed)^qHash(scale.min,seed)^qHash(scale.max,seed)^qHash(scale.power,seed)^qHash(scale.decimals,seed);}
+    };
+    const QLineEditExt::PowerTable &powerTable(const QModelIndex &index, int count) const
+    {
+        PowerScale scale={count,roleValue(index,MinimumRole,0.),roleValue(index,MaximumRole,0.),roleValue(index,PowerRole,2.),index.data(DecimalsRole).toInt()};
+        QHash<PowerScale,QLineEditExt::PowerTable>::const_iterator it=powerTables.constFind(scale);
+        if(it!=powerTables.constEnd())
+            return it.value();
+        if(powerTables.count()>=64)
+            powerTables.clear();
+        return powerTables.insert(scale,QLineEditExt::powerTable(count,scale.min,scale.max,scale.power,pow(10.,scale.decimals))).value();
+    }
+
+    static bool isTextCell(const QModelIndex &index)
+    {
+        QSharedPointer<const QValueDomain> domain=index.data(DomainRole).value<QSharedPointer<const QValueDomain> >();
+        return domain && domain->textIndex() && !domain->textIndex()->isEmpty();
+    }
+    static QString cellText(const QModelIndex &index)
+    {
+        QVariant data=index.data(Qt::EditRole);
+        if(isTextCell(index) || data.userType()==QMetaType::QString) return data.toString();
+        return QString::number(data.toDouble(),'f',index.data(DecimalsRole).toInt());
+    }
+    static bool isIncrementable(const QModelIndex &index)
+    {
+        if(!index.isValid() || !(index.flags()&Qt::ItemIsEditable)) return false;
+        QSharedPointer<const QValueDomain> domain=index.data(DomainRole).value<QSharedPointer<const QValueDomain> >();
+        return (domain && !domain->isEmpty()) || index.data(CountRole).toInt()>0 || roleValue(index,StepRole,0.)>0.;
+    }
+    void increment(const QModelIndex &index, int steps, Qt::KeyboardModifiers modifiers)
+    {
+        if(steps==0 || !index.isValid()) return;
+        QVariant data=steppedData(index,steps,modifiers&Qt::ControlModifier,valueIndex);
+        if(data!=index.data(Qt::EditRole))
+            view->model()->setData(index,data,Qt::EditRole);
+    }
+
+    QAbstractItemView *view;
+    int dragStep;
+    bool wheelIncrement;
+    int wheelSum;
+    QPersistentModelIndex pressedIndex;
+    bool pressed, dragged;
+    QPoint dragStart;
+    int lastIncrement;
+    int valueIndex;
+    mutable QHash<PowerScale,QLineEditExt::PowerTable> powerTables;
+};
+
 #endif // QLINEEDITEXT_H